@@ -4,6 +4,7 @@
 #include<cstring>
 #include"stl_iterator.h"
 #include"type_traits.h"
+#include"stl_utility.h"
 
 namespace grtw
 {
@@ -30,7 +31,7 @@ namespace grtw
 	}
 
 	template<class T>
-	inline T* __copy(T* first, T* last, T* dest)
+	inline T* __copy(const T* first, const T* last, T* dest)
 	{
 		memmove(dest, first, sizeof(T) * (last - first));
 		return dest + (last - first);
@@ -128,6 +129,50 @@ namespace grtw
 		return copy_backward_dispatch<BI1, BI2, Triv>::copy(first, last, dest);
 	}
 
+	//move / move_backward: like copy / copy_backward but leave the source elements moved-from;
+	//types with a trivial assignment take the memmove paths of copy
+	template<class InputIterator, class OutputIterator>
+	inline OutputIterator __move(InputIterator first, InputIterator last, OutputIterator dest, false_type)
+	{
+		for(; first != last; ++first, ++dest)
+			*dest = grtw::move(*first);
+		return dest;
+	}
+
+	template<class InputIterator, class OutputIterator>
+	inline OutputIterator __move(InputIterator first, InputIterator last, OutputIterator dest, true_type)
+	{
+		return grtw::copy(first, last, dest);
+	}
+
+	template<class InputIterator, class OutputIterator>
+	inline OutputIterator move(InputIterator first, InputIterator last, OutputIterator dest)
+	{
+		using Val = typename iterator_traits<InputIterator>::value_type;
+		return __move(first, last, dest, typename type_traits<Val>::has_assignment_operator());
+	}
+
+	template<class BI1, class BI2>
+	inline BI2 __move_backward(BI1 first, BI1 last, BI2 dest, false_type)
+	{
+		while(first != last)
+			*--dest = grtw::move(*--last);
+		return dest;
+	}
+
+	template<class BI1, class BI2>
+	inline BI2 __move_backward(BI1 first, BI1 last, BI2 dest, true_type)
+	{
+		return grtw::copy_backward(first, last, dest);
+	}
+
+	template<class BI1, class BI2>
+	inline BI2 move_backward(BI1 first, BI1 last, BI2 dest)
+	{
+		using Val = typename iterator_traits<BI2>::value_type;
+		return __move_backward(first, last, dest, typename type_traits<Val>::has_assignment_operator());
+	}
+
 	//fill
 	template<class ForwardIterator, class T>
 	inline void fill(ForwardIterator first, ForwardIterator last, const T& v)
@@ -136,6 +181,34 @@ namespace grtw
 			*first = v;
 	}
 
+	//a trivially assignable value whose bytes are all zero is stored with one memset
+	template<class T>
+	inline void __fill(T* first, T* last, const T& v, true_type)
+	{
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&v);
+		size_t i = 0;
+		while(i < sizeof(T) && bytes[i] == 0)
+			++i;
+		if(i == sizeof(T))
+			memset((void*)first, 0, sizeof(T) * (last - first));
+		else
+			for(; first != last; ++first)
+				*first = v;
+	}
+
+	template<class T>
+	inline void __fill(T* first, T* last, const T& v, false_type)
+	{
+		for(; first != last; ++first)
+			*first = v;
+	}
+
+	template<class T>
+	inline void fill(T* first, T* last, const T& v)
+	{
+		__fill(first, last, v, typename type_traits<T>::has_assignment_operator());
+	}
+
 	inline void fill(unsigned char* first, unsigned char* last, const unsigned char& c)
 	{
 		unsigned char tmp = c;
@@ -163,24 +236,33 @@ namespace grtw
 		return first;
 	}
 
+	template<class T, class _Size>
+	inline T* fill_n(T* first, _Size n, const T& v)
+	{
+		if(n <= 0)
+			return first;
+		grtw::fill(first, first + n, v);
+		return first + n;
+	}
+
 	template <class _Size>
 	inline unsigned char* fill_n(unsigned char* first, _Size n, const unsigned char& c)
 	{
-		fill(first, first + n, c);
+		grtw::fill(first, first + n, c);
 		return first + n;
 	}
 
 	template <class _Size>
-	inline signed char* fill_n(char* first, _Size n, const signed char& c)
+	inline signed char* fill_n(signed char* first, _Size n, const signed char& c)
 	{
-		fill(first, first + n, c);
+		grtw::fill(first, first + n, c);
 		return first + n;
 	}
 
 	template <class _Size>
 	inline char* fill_n(char* first, _Size n, const char& c)
 	{
-		fill(first, first + n, c);
+		grtw::fill(first, first + n, c);
 		return first + n;
 	}
 
@@ -213,9 +295,9 @@ namespace grtw
 	template<class T>
 	void swap(T& t1, T& t2)
 	{
-		T tmp = t1;
-		t1 = t2;
-		t2 = tmp;
+		T tmp = grtw::move(t1);
+		t1 = grtw::move(t2);
+		t2 = grtw::move(tmp);
 	}
 
 	template<class T>
@@ -1,52 +1,154 @@
 #ifndef GRTW_STL_ALLOC_H
 #define GRTW_STL_ALLOC_H
 
+#include<cstddef>
 #include<cstdlib>
+#include<cstring>
 #include<new>
+#include<mutex>
+#ifdef GRTW_ALLOC_STATS
+#include<atomic>
+#endif
+#if defined(GRTW_ALLOC_STATS) || defined(GRTW_ALLOC_DEBUG)
+#include<cstdio>
+#endif
 
 namespace grtw
 {
 	using oomh = void();
-	
+
+	//alloc_counter: statistics counter, compiled to nothing unless GRTW_ALLOC_STATS is defined
+	//counters written by one thread only use add(), shared ones use add_shared()
+#ifdef GRTW_ALLOC_STATS
+	struct alloc_counter
+	{
+		std::atomic<size_t> n;
+
+		alloc_counter() : n(0) {}
+		void add(size_t k = 1) { n.store(n.load(std::memory_order_relaxed) + k, std::memory_order_relaxed); }
+		void add_shared(size_t k = 1) { n.fetch_add(k, std::memory_order_relaxed); }
+		void sub_shared(size_t k) { n.fetch_sub(k, std::memory_order_relaxed); }
+		size_t get() const { return n.load(std::memory_order_relaxed); }
+	};
+#else
+	struct alloc_counter
+	{
+		void add(size_t = 1) {}
+		void add_shared(size_t = 1) {}
+		void sub_shared(size_t) {}
+	};
+#endif
+
 	class malloc_alloc
 	{
 	public:
+		//every raw allocator states the alignment all of its blocks are guaranteed
+		static const size_t alignment = alignof(std::max_align_t);
+
 		static void* allocate(size_t);
 		static void deallocate(void*, size_t);
 		static void* reallocate(void*, size_t, size_t);
 
 		static oomh* set_malloc_handler(oomh*);
 
+#ifdef GRTW_ALLOC_STATS
+		struct stats
+		{
+			size_t allocs;
+			size_t frees;
+			size_t reallocs;
+			size_t bytes_in_use;
+			size_t peak_bytes;
+		};
+
+		static stats snapshot();
+		static void dump(FILE*);
+#endif
+
 	private:
 		static void* oom_malloc(size_t n);
 		static void* oom_realloc(void* p, size_t n);
+		static void note_usage(size_t, size_t);
 
 		static oomh* malloc_alloc_oom_handler;
+
+		static alloc_counter allocs;
+		static alloc_counter frees;
+		static alloc_counter reallocs;
+		static alloc_counter bytes_in_use;
+		static alloc_counter peak_bytes;
 	};
 
 	oomh* malloc_alloc::malloc_alloc_oom_handler = nullptr;
+	alloc_counter malloc_alloc::allocs;
+	alloc_counter malloc_alloc::frees;
+	alloc_counter malloc_alloc::reallocs;
+	alloc_counter malloc_alloc::bytes_in_use;
+	alloc_counter malloc_alloc::peak_bytes;
 
 	void* malloc_alloc::allocate(size_t n)
 	{
 		void* res = malloc(n);
 		if(nullptr == res)
 			res = oom_malloc(n);
+		allocs.add_shared();
+		note_usage(0, n);
 		return res;
 	}
 
-	void malloc_alloc::deallocate(void* p, size_t)
+	void malloc_alloc::deallocate(void* p, size_t n)
 	{
 		free(p);
+		frees.add_shared();
+		note_usage(n, 0);
 	}
 
-	void* malloc_alloc::reallocate(void* p, size_t, size_t new_size)
+	void* malloc_alloc::reallocate(void* p, size_t old_size, size_t new_size)
 	{
 		void* res = realloc(p, new_size);
 		if(nullptr == res)
 			res = oom_realloc(p, new_size);
+		reallocs.add_shared();
+		note_usage(old_size, new_size);
+		return res;
+	}
+
+	//usage follows the sizes callers report, which is all malloc_alloc is told
+	void malloc_alloc::note_usage(size_t released, size_t acquired)
+	{
+#ifdef GRTW_ALLOC_STATS
+		bytes_in_use.add_shared(acquired);
+		bytes_in_use.sub_shared(released);
+		size_t now = bytes_in_use.get();
+		size_t peak = peak_bytes.get();
+		while(now > peak && !peak_bytes.n.compare_exchange_weak(peak, now, std::memory_order_relaxed))
+			;
+#else
+		(void)released;
+		(void)acquired;
+#endif
+	}
+
+#ifdef GRTW_ALLOC_STATS
+	malloc_alloc::stats malloc_alloc::snapshot()
+	{
+		stats res;
+		res.allocs = allocs.get();
+		res.frees = frees.get();
+		res.reallocs = reallocs.get();
+		res.bytes_in_use = bytes_in_use.get();
+		res.peak_bytes = peak_bytes.get();
 		return res;
 	}
 
+	void malloc_alloc::dump(FILE* out)
+	{
+		stats st = snapshot();
+		fprintf(out, "malloc_alloc: allocs %zu frees %zu reallocs %zu in use %zu peak %zu\n",
+			st.allocs, st.frees, st.reallocs, st.bytes_in_use, st.peak_bytes);
+	}
+#endif
+
 	oomh* malloc_alloc::set_malloc_handler(oomh* p)
 	{
 		oomh* old = malloc_alloc_oom_handler;
@@ -90,22 +192,104 @@ namespace grtw
 		}
 	}
 
-	#define ALIGN 8
-	#define MAX_BYTES 128
-	#define NFREELISTS 16
+	constexpr size_t static_log2(size_t n)
+	{
+		return n <= 1 ? 0 : 1 + static_log2(n >> 1);
+	}
 
-	class default_alloc
+	//size_classes: Steps classes spaced Align apart, then Steps classes per doubling up to MaxBytes,
+	//every class size a multiple of Align
+	template<size_t Align = 16, size_t MaxBytes = 4096, size_t Steps = 4>
+	struct size_classes
+	{
+		static_assert(Align >= sizeof(void*) && (Align & (Align - 1)) == 0, "Align must be a power of two no smaller than a pointer");
+		static_assert(Steps > 0 && (Steps & (Steps - 1)) == 0, "Steps must be a power of two");
+		static_assert(MaxBytes >= Steps * Align && ((MaxBytes / (Steps * Align)) & (MaxBytes / (Steps * Align) - 1)) == 0
+			&& MaxBytes % (Steps * Align) == 0, "MaxBytes must be Steps * Align times a power of two");
+
+		static const size_t align = Align;
+		static const size_t max_bytes = MaxBytes;
+		static const size_t nclasses = Steps * (static_log2(MaxBytes / (Steps * Align)) + 1);
+
+		static size_t index(size_t bytes)
+		{
+			size_t q = (bytes + Align - 1) / Align;
+			if(q <= Steps)
+				return q == 0 ? 0 : q - 1;
+			size_t g = 64 - __builtin_clzll((q - 1) / Steps);
+			size_t step = size_t(1) << (g - 1);
+			return g * Steps + (q - (Steps << (g - 1)) + step - 1) / step - 1;
+		}
+
+		static size_t class_size(size_t index)
+		{
+			if(index < Steps)
+				return (index + 1) * Align;
+			size_t g = index / Steps;
+			size_t j = index % Steps + 1;
+			return ((Steps << (g - 1)) + (j << (g - 1))) * Align;
+		}
+	};
+
+	//basic_default_alloc: each thread keeps a magazine of free objects per size class,
+	//free_lists is the shared depot, guarded by depot_mutex and touched in batches only
+	template<class SizeClasses>
+	class basic_default_alloc
 	{
 	public:
+		static const size_t alignment = SizeClasses::align;
+
 		static void* allocate(size_t);
 		static void deallocate(void*, size_t);
 		static void* reallocate(void*, size_t, size_t);
 
+		static void flush_thread_cache();
+		static size_t trim();
+		static void set_trim_threshold(size_t);
+
+#ifdef GRTW_ALLOC_STATS
+		struct class_stats
+		{
+			size_t size;
+			size_t allocs;
+			size_t frees;
+			size_t refills;
+			size_t flushes;
+			size_t depot_bytes;
+			size_t cached_bytes;
+		};
+
+		struct stats
+		{
+			class_stats classes[SizeClasses::nclasses];
+			size_t large_allocs;
+			size_t large_frees;
+			size_t heap_size;
+			size_t peak_heap_size;
+			size_t depot_bytes;
+			size_t cached_bytes;
+			size_t slack_bytes;
+			size_t in_use_bytes;
+			double fragmentation;
+		};
+
+		static stats snapshot();
+		static void dump(FILE*);
+#endif
+
 	private:
-		static size_t round_up(size_t);
-		static size_t free_list_index(size_t);
+		enum { NCLASSES = SizeClasses::nclasses, NMAGAZINE = 32, MAGAZINE_BYTES = 16384 };
+
+		static int magazine_size(size_t);
+		static void* raw_allocate(size_t);
 		static void* refill(size_t);
+		static void* depot_allocate(size_t);
+		static void depot_deallocate(void*, size_t);
 		static char* chunk_alloc(size_t, int&);
+		static void release_slack();
+		static bool record_chunk(char*, size_t);
+		static size_t find_chunk(const char*);
+		static size_t release_free_chunks();
 
 	private:
 		union obj
@@ -113,101 +297,628 @@ namespace grtw
 			union obj* next;
 			char client_data[1];
 		};
-		static obj* free_lists[NFREELISTS];
+
+		struct class_counters
+		{
+			alloc_counter allocs;
+			alloc_counter frees;
+			alloc_counter refills;
+			alloc_counter flushes;
+			alloc_counter objs_in;
+			alloc_counter objs_out;
+		};
+
+		struct thread_cache
+		{
+			obj* lists[NCLASSES];
+			int counts[NCLASSES];
+			class_counters counters[NCLASSES];
+#ifdef GRTW_ALLOC_STATS
+			thread_cache* prev;
+			thread_cache* next;
+#endif
+
+			thread_cache();
+			~thread_cache();
+			void flush(size_t, int);
+		};
+
+		struct chunk
+		{
+			char* start;
+			size_t size;
+		};
+
+		static thread_cache& local_cache();
+		//set once the calling thread's cache is destroyed: thread_locals destroyed after it
+		//still free memory, and must not touch the dead cache. A plain bool has no destructor,
+		//so it stays readable until the thread is gone
+		static thread_local bool cache_gone;
+
+		static obj* free_lists[NCLASSES];
 
 		static char* start_free;
 		static char* end_free;
 		static size_t heap_size;
+		static std::mutex depot_mutex;
+
+		//every block obtained from raw_allocate, so fully free ones can be handed back
+		static chunk* chunks;
+		static size_t nchunks;
+		static size_t chunks_capacity;
+		//bytes sitting in free_lists; once above next_trim, a flush trims the pool
+		static size_t depot_bytes;
+		static size_t trim_threshold;
+		static size_t next_trim;
+
+#ifdef GRTW_ALLOC_STATS
+		//live thread caches, and the totals of caches whose threads have exited
+		static thread_cache* caches;
+		static class_counters retired[NCLASSES];
+		static size_t peak_heap_size;
+#endif
+		static alloc_counter large_allocs;
+		static alloc_counter large_frees;
 	};
 
-	char* default_alloc::start_free = nullptr;
-	char* default_alloc::end_free = nullptr;
-	size_t default_alloc::heap_size = 0;
-	default_alloc::obj* default_alloc::free_lists[NFREELISTS] = {nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,nullptr};
+	using default_alloc = basic_default_alloc<size_classes<>>;
 
-	size_t default_alloc::round_up(size_t bytes)
+	template<class SizeClasses>
+	char* basic_default_alloc<SizeClasses>::start_free = nullptr;
+
+	template<class SizeClasses>
+	char* basic_default_alloc<SizeClasses>::end_free = nullptr;
+
+	template<class SizeClasses>
+	size_t basic_default_alloc<SizeClasses>::heap_size = 0;
+
+	template<class SizeClasses>
+	std::mutex basic_default_alloc<SizeClasses>::depot_mutex;
+
+	template<class SizeClasses>
+	thread_local bool basic_default_alloc<SizeClasses>::cache_gone = false;
+
+	template<class SizeClasses>
+	typename basic_default_alloc<SizeClasses>::chunk* basic_default_alloc<SizeClasses>::chunks = nullptr;
+
+	template<class SizeClasses>
+	size_t basic_default_alloc<SizeClasses>::nchunks = 0;
+
+	template<class SizeClasses>
+	size_t basic_default_alloc<SizeClasses>::chunks_capacity = 0;
+
+	template<class SizeClasses>
+	size_t basic_default_alloc<SizeClasses>::depot_bytes = 0;
+
+	template<class SizeClasses>
+	size_t basic_default_alloc<SizeClasses>::trim_threshold = 0;
+
+	template<class SizeClasses>
+	size_t basic_default_alloc<SizeClasses>::next_trim = 0;
+
+#ifdef GRTW_ALLOC_STATS
+	template<class SizeClasses>
+	typename basic_default_alloc<SizeClasses>::thread_cache* basic_default_alloc<SizeClasses>::caches = nullptr;
+
+	template<class SizeClasses>
+	typename basic_default_alloc<SizeClasses>::class_counters basic_default_alloc<SizeClasses>::retired[NCLASSES];
+
+	template<class SizeClasses>
+	size_t basic_default_alloc<SizeClasses>::peak_heap_size = 0;
+#endif
+
+	template<class SizeClasses>
+	alloc_counter basic_default_alloc<SizeClasses>::large_allocs;
+
+	template<class SizeClasses>
+	alloc_counter basic_default_alloc<SizeClasses>::large_frees;
+
+	template<class SizeClasses>
+	typename basic_default_alloc<SizeClasses>::obj* basic_default_alloc<SizeClasses>::free_lists[NCLASSES];
+
+	template<class SizeClasses>
+	basic_default_alloc<SizeClasses>::thread_cache::thread_cache()
 	{
-		return (bytes + ALIGN - 1) &~(ALIGN - 1);
+		for(int i = 0; i < NCLASSES; i++)
+		{
+			lists[i] = nullptr;
+			counts[i] = 0;
+		}
+#ifdef GRTW_ALLOC_STATS
+		std::lock_guard<std::mutex> guard(depot_mutex);
+		prev = nullptr;
+		next = caches;
+		if(caches)
+			caches->prev = this;
+		caches = this;
+#endif
 	}
 
-	size_t default_alloc::free_list_index(size_t bytes)
+	template<class SizeClasses>
+	basic_default_alloc<SizeClasses>::thread_cache::~thread_cache()
 	{
-		return ((bytes + ALIGN - 1)/ALIGN - 1);
+		for(int i = 0; i < NCLASSES; i++)
+			flush(i, counts[i]);
+#ifdef GRTW_ALLOC_STATS
+		std::lock_guard<std::mutex> guard(depot_mutex);
+		for(int i = 0; i < NCLASSES; i++)
+		{
+			retired[i].allocs.add(counters[i].allocs.get());
+			retired[i].frees.add(counters[i].frees.get());
+			retired[i].refills.add(counters[i].refills.get());
+			retired[i].flushes.add(counters[i].flushes.get());
+			retired[i].objs_in.add(counters[i].objs_in.get());
+			retired[i].objs_out.add(counters[i].objs_out.get());
+		}
+		if(prev)
+			prev->next = next;
+		else
+			caches = next;
+		if(next)
+			next->prev = prev;
+#endif
+		cache_gone = true;
 	}
 
-	void* default_alloc::allocate(size_t n)
+	//hand the first n cached objects of class index back to the depot
+	template<class SizeClasses>
+	void basic_default_alloc<SizeClasses>::thread_cache::flush(size_t index, int n)
 	{
-		if(n > MAX_BYTES)
+		if(n <= 0)
+			return;
+
+		obj* first = lists[index];
+		obj* last = first;
+		for(int i = 1; i < n; i++)
+			last = last->next;
+		lists[index] = last->next;
+		counts[index] -= n;
+		counters[index].flushes.add();
+		counters[index].objs_out.add(n);
+
+		std::lock_guard<std::mutex> guard(depot_mutex);
+		last->next = free_lists[index];
+		free_lists[index] = first;
+		depot_bytes += n * SizeClasses::class_size(index);
+		if(trim_threshold != 0 && depot_bytes > next_trim)
 		{
-			return malloc_alloc::allocate(n);
+			release_free_chunks();
+			next_trim = depot_bytes + trim_threshold;
 		}
+	}
 
-		int index = free_list_index(n);
-		obj* res = free_lists[index];
+	template<class SizeClasses>
+	typename basic_default_alloc<SizeClasses>::thread_cache& basic_default_alloc<SizeClasses>::local_cache()
+	{
+		static thread_local thread_cache cache;
+		return cache;
+	}
+
+	template<class SizeClasses>
+	void basic_default_alloc<SizeClasses>::flush_thread_cache()
+	{
+		if(cache_gone)
+			return;
+		thread_cache& cache = local_cache();
+		for(int i = 0; i < NCLASSES; i++)
+			cache.flush(i, cache.counts[i]);
+	}
+
+	//give every fully free chunk back to the system, returns the bytes released
+	//objects cached by other threads keep their chunks alive
+	template<class SizeClasses>
+	size_t basic_default_alloc<SizeClasses>::trim()
+	{
+		flush_thread_cache();
+		std::lock_guard<std::mutex> guard(depot_mutex);
+		return release_free_chunks();
+	}
+
+	//trim automatically whenever the depot grows by more than bytes since the last trim, 0 disables
+	template<class SizeClasses>
+	void basic_default_alloc<SizeClasses>::set_trim_threshold(size_t bytes)
+	{
+		std::lock_guard<std::mutex> guard(depot_mutex);
+		trim_threshold = bytes;
+		next_trim = depot_bytes + bytes;
+	}
+
+#ifdef GRTW_ALLOC_STATS
+	template<class SizeClasses>
+	typename basic_default_alloc<SizeClasses>::stats basic_default_alloc<SizeClasses>::snapshot()
+	{
+		stats res;
+		std::lock_guard<std::mutex> guard(depot_mutex);
+		res.depot_bytes = 0;
+		res.cached_bytes = 0;
+		for(size_t i = 0; i < NCLASSES; i++)
+		{
+			class_stats& cs = res.classes[i];
+			cs.size = SizeClasses::class_size(i);
+			cs.allocs = retired[i].allocs.get();
+			cs.frees = retired[i].frees.get();
+			cs.refills = retired[i].refills.get();
+			cs.flushes = retired[i].flushes.get();
+			size_t objs_in = retired[i].objs_in.get();
+			size_t objs_out = retired[i].objs_out.get();
+			for(thread_cache* c = caches; c != nullptr; c = c->next)
+			{
+				cs.allocs += c->counters[i].allocs.get();
+				cs.frees += c->counters[i].frees.get();
+				cs.refills += c->counters[i].refills.get();
+				cs.flushes += c->counters[i].flushes.get();
+				objs_in += c->counters[i].objs_in.get();
+				objs_out += c->counters[i].objs_out.get();
+			}
+			//objects a cache received minus those it gave back or handed out
+			long long cached = (long long)objs_in - (long long)objs_out - (long long)cs.allocs + (long long)cs.frees;
+			cs.cached_bytes = cached > 0 ? size_t(cached) * cs.size : 0;
+			cs.depot_bytes = 0;
+			for(obj* p = free_lists[i]; p != nullptr; p = p->next)
+				cs.depot_bytes += cs.size;
+			res.depot_bytes += cs.depot_bytes;
+			res.cached_bytes += cs.cached_bytes;
+		}
+		res.large_allocs = large_allocs.get();
+		res.large_frees = large_frees.get();
+		res.heap_size = heap_size;
+		res.peak_heap_size = peak_heap_size;
+		res.slack_bytes = end_free - start_free;
+		size_t free_bytes = res.depot_bytes + res.cached_bytes + res.slack_bytes;
+		res.in_use_bytes = heap_size > free_bytes ? heap_size - free_bytes : 0;
+		res.fragmentation = heap_size == 0 ? 0.0 : double(free_bytes) / double(heap_size);
+		return res;
+	}
+
+	template<class SizeClasses>
+	void basic_default_alloc<SizeClasses>::dump(FILE* out)
+	{
+		stats st = snapshot();
+		fprintf(out, "default_alloc: heap %zu peak %zu in use %zu free lists %zu thread caches %zu slack %zu fragmentation %.3f\n",
+			st.heap_size, st.peak_heap_size, st.in_use_bytes, st.depot_bytes, st.cached_bytes, st.slack_bytes, st.fragmentation);
+		fprintf(out, "  large allocs %zu frees %zu\n", st.large_allocs, st.large_frees);
+		fprintf(out, "  %8s %12s %12s %10s %10s %12s %12s\n", "size", "allocs", "frees", "refills", "flushes", "free lists", "caches");
+		for(size_t i = 0; i < NCLASSES; i++)
+		{
+			const class_stats& cs = st.classes[i];
+			if(cs.allocs == 0 && cs.depot_bytes == 0)
+				continue;
+			fprintf(out, "  %8zu %12zu %12zu %10zu %10zu %12zu %12zu\n",
+				cs.size, cs.allocs, cs.frees, cs.refills, cs.flushes, cs.depot_bytes, cs.cached_bytes);
+		}
+	}
+#endif
+
+	//objects moved per refill/flush: NMAGAZINE for small classes, fewer for large ones
+	template<class SizeClasses>
+	int basic_default_alloc<SizeClasses>::magazine_size(size_t bytes)
+	{
+		size_t n = MAGAZINE_BYTES / bytes;
+		return n < 2 ? 2 : (n > NMAGAZINE ? NMAGAZINE : int(n));
+	}
+
+	//malloc, or posix_memalign when the classes need more than malloc's alignment
+	template<class SizeClasses>
+	void* basic_default_alloc<SizeClasses>::raw_allocate(size_t n)
+	{
+		if(SizeClasses::align <= alignof(std::max_align_t))
+			return malloc(n);
+		void* res;
+		return posix_memalign(&res, SizeClasses::align, n) == 0 ? res : nullptr;
+	}
+
+	template<class SizeClasses>
+	void* basic_default_alloc<SizeClasses>::allocate(size_t n)
+	{
+		if(n > SizeClasses::max_bytes)
+		{
+			large_allocs.add_shared();
+			if(SizeClasses::align <= alignof(std::max_align_t))
+				return malloc_alloc::allocate(n);
+			void* res = raw_allocate(n);
+			if(nullptr == res)
+				throw std::bad_alloc();
+			return res;
+		}
+
+		size_t index = SizeClasses::index(n);
+		if(cache_gone)
+			return depot_allocate(index);
+		thread_cache& cache = local_cache();
+		cache.counters[index].allocs.add();
+		obj* res = cache.lists[index];
 		if(res)
 		{
-			free_lists[index] = res->next;
+			cache.lists[index] = res->next;
+			--cache.counts[index];
 			return (void*)res;
 		}
 		else
 		{
-			void* r = refill(round_up(n));
+			void* r = refill(SizeClasses::class_size(index));
 			return r;
 		}
 	}
 
-	void default_alloc::deallocate(void* p, size_t n)
+	template<class SizeClasses>
+	void basic_default_alloc<SizeClasses>::deallocate(void* p, size_t n)
 	{
-		if(n > MAX_BYTES)
+		if(n > SizeClasses::max_bytes)
 		{
-			free(p);
+			large_frees.add_shared();
+			if(SizeClasses::align <= alignof(std::max_align_t))
+				malloc_alloc::deallocate(p, n);
+			else
+				free(p);
 			return;
 		}
 		else
 		{
-			int index = free_list_index(n);
+			size_t index = SizeClasses::index(n);
+			if(cache_gone)
+			{
+				depot_deallocate(p, index);
+				return;
+			}
+			thread_cache& cache = local_cache();
+			cache.counters[index].frees.add();
 			obj* ptr = static_cast<obj*>(p);
-			ptr->next = free_lists[index];
-			free_lists[index] = ptr;
+			ptr->next = cache.lists[index];
+			cache.lists[index] = ptr;
+			int magazine = magazine_size(SizeClasses::class_size(index));
+			if(++cache.counts[index] >= 2 * magazine)
+				cache.flush(index, magazine);
 		}
 	}
 
-	void* default_alloc::reallocate(void* p, size_t old_size, size_t new_size)
+	template<class SizeClasses>
+	void* basic_default_alloc<SizeClasses>::reallocate(void* p, size_t old_size, size_t new_size)
 	{
+		if(p == nullptr)
+			return allocate(new_size);
+		//large blocks on both sides go to realloc, which may extend them in place
+		if(old_size > SizeClasses::max_bytes && new_size > SizeClasses::max_bytes && SizeClasses::align <= alignof(std::max_align_t))
+			return malloc_alloc::reallocate(p, old_size, new_size);
+		if(old_size <= SizeClasses::max_bytes && new_size <= SizeClasses::max_bytes && SizeClasses::index(old_size) == SizeClasses::index(new_size))
+			return p;
+		void* res = allocate(new_size);
+		memcpy(res, p, old_size < new_size ? old_size : new_size);
 		deallocate(p, old_size);
-		p = allocate(new_size);
-		return p;
+		return res;
 	}
 
-	void* default_alloc::refill(size_t n)
+	//move a magazine of objects into the calling thread's cache: taken from the depot
+	//if it has any, otherwise carved from a fresh chunk
+	template<class SizeClasses>
+	void* basic_default_alloc<SizeClasses>::refill(size_t n)
 	{
-		int numofobjs = 20;
+		size_t index = SizeClasses::index(n);
+		int magazine = magazine_size(n);
+		int numofobjs = magazine;
+		obj* res;
+		char* chunk = nullptr;
+		{
+			std::lock_guard<std::mutex> guard(depot_mutex);
+			res = free_lists[index];
+			if(res)
+			{
+				obj* last = res;
+				numofobjs = 1;
+				while(numofobjs < magazine && last->next != nullptr)
+				{
+					last = last->next;
+					++numofobjs;
+				}
+				free_lists[index] = last->next;
+				last->next = nullptr;
+				depot_bytes -= numofobjs * n;
+			}
+			else
+			{
+				chunk = chunk_alloc(n, numofobjs);
+				if(chunk == nullptr)
+					throw std::bad_alloc();
+			}
+		}
+
+		if(chunk)
+		{
+			res = (obj*)chunk;
+			obj* current = res;
+			for(int i = 1; i < numofobjs; i++)
+			{
+				current->next = (obj*)((char*)current + n);
+				current = current->next;
+			}
+			current->next = nullptr;
+		}
+
+		thread_cache& cache = local_cache();
+		cache.lists[index] = res->next;
+		cache.counts[index] = numofobjs - 1;
+		cache.counters[index].refills.add();
+		cache.counters[index].objs_in.add(numofobjs);
+		return res;
+	}
+
+	//one object of class index straight from the depot, for a thread whose cache is gone;
+	//it counts as passing through a cache so the stats stay balanced
+	template<class SizeClasses>
+	void* basic_default_alloc<SizeClasses>::depot_allocate(size_t index)
+	{
+		size_t n = SizeClasses::class_size(index);
+		std::lock_guard<std::mutex> guard(depot_mutex);
+#ifdef GRTW_ALLOC_STATS
+		retired[index].allocs.add();
+		retired[index].objs_in.add();
+#endif
+		obj* res = free_lists[index];
+		if(res)
+		{
+			free_lists[index] = res->next;
+			depot_bytes -= n;
+			return res;
+		}
+		int numofobjs = 1;
 		char* chunk = chunk_alloc(n, numofobjs);
-		if(numofobjs == 1)
-			return chunk;
+		if(chunk == nullptr)
+			throw std::bad_alloc();
+		return chunk;
+	}
+
+	template<class SizeClasses>
+	void basic_default_alloc<SizeClasses>::depot_deallocate(void* p, size_t index)
+	{
+		std::lock_guard<std::mutex> guard(depot_mutex);
+#ifdef GRTW_ALLOC_STATS
+		retired[index].frees.add();
+		retired[index].objs_out.add();
+#endif
+		obj* ptr = static_cast<obj*>(p);
+		ptr->next = free_lists[index];
+		free_lists[index] = ptr;
+		depot_bytes += SizeClasses::class_size(index);
+	}
+
+	//file the start_free..end_free leftover under the largest classes that fit it
+	//caller holds depot_mutex
+	template<class SizeClasses>
+	void basic_default_alloc<SizeClasses>::release_slack()
+	{
+		size_t bytes_left = end_free - start_free;
+		while(bytes_left >= SizeClasses::align)
+		{
+			size_t index = SizeClasses::index(bytes_left);
+			if(SizeClasses::class_size(index) > bytes_left)
+				--index;
+			size_t bytes = SizeClasses::class_size(index);
+			((obj*)start_free)->next = free_lists[index];
+			free_lists[index] = (obj*)start_free;
+			start_free += bytes;
+			bytes_left -= bytes;
+			depot_bytes += bytes;
+		}
+	}
+
+	//caller holds depot_mutex
+	template<class SizeClasses>
+	bool basic_default_alloc<SizeClasses>::record_chunk(char* start, size_t size)
+	{
+		if(nchunks == chunks_capacity)
+		{
+			size_t new_capacity = chunks_capacity == 0 ? 16 : 2 * chunks_capacity;
+			chunk* tmp = (chunk*)realloc(chunks, new_capacity * sizeof(chunk));
+			if(tmp == nullptr)
+				return false;
+			chunks = tmp;
+			chunks_capacity = new_capacity;
+		}
+		chunks[nchunks].start = start;
+		chunks[nchunks].size = size;
+		++nchunks;
+		return true;
+	}
+
+	//index of the chunk holding p, chunks must be sorted by address
+	template<class SizeClasses>
+	size_t basic_default_alloc<SizeClasses>::find_chunk(const char* p)
+	{
+		size_t lo = 0;
+		size_t hi = nchunks;
+		while(hi - lo > 1)
+		{
+			size_t mid = lo + (hi - lo) / 2;
+			if(chunks[mid].start <= p)
+				lo = mid;
+			else
+				hi = mid;
+		}
+		return lo;
+	}
+
+	//caller holds depot_mutex
+	template<class SizeClasses>
+	size_t basic_default_alloc<SizeClasses>::release_free_chunks()
+	{
+		if(nchunks == 0)
+			return 0;
+
+		//insertion sort: chunks are few and mostly appended in address order
+		for(size_t i = 1; i < nchunks; i++)
+		{
+			chunk c = chunks[i];
+			size_t j = i;
+			for(; j > 0 && chunks[j - 1].start > c.start; j--)
+				chunks[j] = chunks[j - 1];
+			chunks[j] = c;
+		}
 
-		obj* res = (obj*)chunk;
-		obj* next_obj = (obj*)(chunk + n);
-		obj* current = next_obj;
-		free_lists[free_list_index(n)] = current;
-		for(int i = 2; i <= numofobjs; i++)
+		size_t* free_bytes = (size_t*)calloc(nchunks, sizeof(size_t));
+		if(free_bytes == nullptr)
+			return 0;
+		for(size_t i = 0; i < NCLASSES; i++)
+			for(obj* p = free_lists[i]; p != nullptr; p = p->next)
+				free_bytes[find_chunk((char*)p)] += SizeClasses::class_size(i);
+		if(start_free != end_free)
+			free_bytes[find_chunk(start_free)] += end_free - start_free;
+
+		//a fully free chunk is flagged by free_bytes == 0 from here on
+		bool any = false;
+		for(size_t i = 0; i < nchunks; i++)
 		{
-			if(i == numofobjs)
+			if(free_bytes[i] == chunks[i].size)
 			{
-				current->next = nullptr;
-				break;
+				free_bytes[i] = 0;
+				any = true;
 			}
 			else
+				++free_bytes[i];
+		}
+
+		size_t released = 0;
+		if(any)
+		{
+			for(size_t i = 0; i < NCLASSES; i++)
+			{
+				obj** link = &free_lists[i];
+				while(*link != nullptr)
+				{
+					if(free_bytes[find_chunk((char*)*link)] == 0)
+					{
+						*link = (*link)->next;
+						depot_bytes -= SizeClasses::class_size(i);
+					}
+					else
+						link = &(*link)->next;
+				}
+			}
+			if(start_free != end_free && free_bytes[find_chunk(start_free)] == 0)
+			{
+				start_free = nullptr;
+				end_free = nullptr;
+			}
+
+			size_t kept = 0;
+			for(size_t i = 0; i < nchunks; i++)
 			{
-				next_obj = (obj*)((char*)(next_obj) + n);
-				current->next = next_obj;
-				current = next_obj;
+				if(free_bytes[i] == 0)
+				{
+					free(chunks[i].start);
+					released += chunks[i].size;
+				}
+				else
+					chunks[kept++] = chunks[i];
 			}
+			nchunks = kept;
+			heap_size -= released;
 		}
-		return res;
+		free(free_bytes);
+		return released;
 	}
 
-	char* default_alloc::chunk_alloc(size_t bytes, int& n)
+	//caller holds depot_mutex
+	template<class SizeClasses>
+	char* basic_default_alloc<SizeClasses>::chunk_alloc(size_t bytes, int& n)
 	{
 		char* res;
 		size_t bytes_required = n * bytes;
@@ -229,25 +940,26 @@ namespace grtw
 		}
 		else
 		{
-			size_t byte_to_get = 2 * bytes_required + round_up(heap_size >> 4);
-			if(bytes_left > 0)
+			const size_t align = SizeClasses::align;
+			size_t byte_to_get = 2 * bytes_required + ((heap_size >> 4) + align - 1) / align * align;
+			release_slack();
+
+			start_free = (char*)raw_allocate(byte_to_get);
+			if(start_free != nullptr && !record_chunk(start_free, byte_to_get))
 			{
-				obj* tmp = free_lists[free_list_index(bytes_left)];
-				((obj*)start_free)->next = tmp;
-				free_lists[free_list_index(bytes_left)] = (obj*)start_free;
+				free(start_free);
+				start_free = nullptr;
 			}
-
-			start_free = (char*)malloc(byte_to_get);
 			if(start_free == nullptr)
 			{
-				for(int i = bytes; i <= MAX_BYTES; i+=ALIGN)
+				for(size_t ind = SizeClasses::index(bytes); ind < NCLASSES; ind++)
 				{
-					int ind = free_list_index(i);
 					if(free_lists[ind] != nullptr)
 					{
-						free_lists[ind] = free_lists[ind]->next;
 						start_free = (char*)(free_lists[ind]);
-						end_free = start_free + i;
+						free_lists[ind] = free_lists[ind]->next;
+						depot_bytes -= SizeClasses::class_size(ind);
+						end_free = start_free + SizeClasses::class_size(ind);
 						return chunk_alloc(bytes, n);
 					}
 				}
@@ -257,11 +969,108 @@ namespace grtw
 			else
 			{
 				heap_size += byte_to_get;
+#ifdef GRTW_ALLOC_STATS
+				if(heap_size > peak_heap_size)
+					peak_heap_size = heap_size;
+#endif
 				end_free = start_free + byte_to_get;
 				return chunk_alloc(bytes, n);
 			}
 		}
 	}
+
+#ifdef GRTW_ALLOC_DEBUG
+	//debug_alloc: every block carries a header with its size and state and a guard word after
+	//it; freed blocks are poisoned, and a double free, a size that differs from the allocated
+	//one or an overrun guard aborts with a message. allocator<T, Alloc> routes through it when
+	//GRTW_ALLOC_DEBUG is defined, otherwise none of this is compiled
+	template<class Alloc>
+	class debug_alloc
+	{
+	public:
+		static const size_t alignment = Alloc::alignment;
+
+		static void* allocate(size_t);
+		static void deallocate(void*, size_t);
+		static void* reallocate(void*, size_t, size_t);
+
+	private:
+		//the pools link free blocks through their first word, so state goes in the second
+		struct header
+		{
+			size_t size;
+			size_t state;
+		};
+
+		enum : size_t { LIVE = 0x4c49564542304c4bULL, FREED = 0x4652454544424c4bULL, GUARD = 0xfdfdfdfdfdfdfdfdULL };
+		enum { ALLOC_FILL = 0xcd, FREE_FILL = 0xdd };
+
+		static size_t header_size() { return (sizeof(header) + alignment - 1) & ~(alignment - 1); }
+		static size_t block_size(size_t n) { return header_size() + n + sizeof(size_t); }
+		static header* get_header(void* p) { return (header*)((char*)p - header_size()); }
+		static void check(void*, size_t);
+		static void fail(const char*, void*, size_t, size_t);
+	};
+
+	template<class Alloc>
+	void* debug_alloc<Alloc>::allocate(size_t n)
+	{
+		char* raw = (char*)Alloc::allocate(block_size(n));
+		header* h = (header*)raw;
+		h->size = n;
+		h->state = LIVE;
+		char* p = raw + header_size();
+		memset(p, ALLOC_FILL, n);
+		size_t guard = GUARD;
+		memcpy(p + n, &guard, sizeof(guard));
+		return p;
+	}
+
+	template<class Alloc>
+	void debug_alloc<Alloc>::deallocate(void* p, size_t n)
+	{
+		check(p, n);
+		header* h = get_header(p);
+		h->state = FREED;
+		memset(p, FREE_FILL, n);
+		Alloc::deallocate(h, block_size(n));
+	}
+
+	template<class Alloc>
+	void* debug_alloc<Alloc>::reallocate(void* p, size_t old_size, size_t new_size)
+	{
+		if(p == nullptr)
+			return allocate(new_size);
+		check(p, old_size);
+		void* res = allocate(new_size);
+		memcpy(res, p, old_size < new_size ? old_size : new_size);
+		deallocate(p, old_size);
+		return res;
+	}
+
+	template<class Alloc>
+	void debug_alloc<Alloc>::check(void* p, size_t n)
+	{
+		header* h = get_header(p);
+		if(h->state == FREED)
+			fail("double free", p, n, n);
+		if(h->state != LIVE)
+			fail("free of a block not allocated here", p, n, 0);
+		if(h->size != n)
+			fail("size mismatch", p, n, h->size);
+		size_t guard;
+		memcpy(&guard, (char*)p + n, sizeof(guard));
+		if(guard != GUARD)
+			fail("write past the end", p, n, h->size);
+	}
+
+	template<class Alloc>
+	void debug_alloc<Alloc>::fail(const char* what, void* p, size_t n, size_t allocated)
+	{
+		fprintf(stderr, "debug_alloc: %s: block %p, freed with size %zu, allocated with size %zu\n", what, p, n, allocated);
+		abort();
+	}
+#endif
 }
 
-#endif
\ No newline at end of file
+#endif
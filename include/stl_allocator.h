@@ -1,11 +1,17 @@
 #ifndef GRTW_STL_ALLOCATOR_H
 #define GRTW_STL_ALLOCATOR_H
 
+#include<cstdint>
+#include<cstring>
 #include"stl_alloc.h"
+#include"type_traits.h"
 
 namespace grtw
 {
-	template<class T>
+	//Align raises the alignment of the returned storage above alignof(T), e.g. to a cache line;
+	//when Alloc does not already guarantee it, blocks are over-allocated and the raw pointer is
+	//kept just below the aligned one
+	template<class T, class Alloc = default_alloc, size_t Align = alignof(T)>
 	class allocator
 	{
 	public:
@@ -17,64 +23,127 @@ namespace grtw
 		using size_type = size_t;
 		using difference_type = ptrdiff_t;
 
+		static const size_t alignment = Align < alignof(T) ? alignof(T) : Align;
+		static_assert((alignment & (alignment - 1)) == 0, "Align must be a power of two");
+
+		allocator() {}
+		template<class U, size_t A>
+		allocator(const allocator<U, Alloc, A>&) {}
+
 		static T* allocate();
 		static T* allocate(size_t);
 		static void deallocate(T*);
 		static void deallocate(T*, size_t);
+		static T* reallocate(T*, size_t, size_t);
 		static void construct(T*);
 		static void construct(T*, const T&);
 		static void destroy(T*);
 		static void destroy(T*, T*);
+
+	private:
+#ifdef GRTW_ALLOC_DEBUG
+		using raw_alloc = debug_alloc<Alloc>;
+#else
+		using raw_alloc = Alloc;
+#endif
+		using over_aligned = typename Bool_type<(alignment > raw_alloc::alignment)>::type;
+
+		static const size_t overhead = alignment + sizeof(void*);
+
+		static void* raw_allocate(size_t bytes, false_type) { return raw_alloc::allocate(bytes); }
+		static void* raw_allocate(size_t, true_type);
+		static void raw_deallocate(void* p, size_t bytes, false_type) { raw_alloc::deallocate(p, bytes); }
+		static void raw_deallocate(void* p, size_t bytes, true_type) { raw_alloc::deallocate(((void**)p)[-1], bytes + overhead); }
+		static void* raw_reallocate(void* p, size_t old_bytes, size_t new_bytes, false_type) { return raw_alloc::reallocate(p, old_bytes, new_bytes); }
+		static void* raw_reallocate(void*, size_t, size_t, true_type);
 	};
 
-	template<class T>
-	T* allocator<T>::allocate()
+	template<class T1, size_t A1, class T2, size_t A2, class Alloc>
+	inline bool operator==(const allocator<T1, Alloc, A1>&, const allocator<T2, Alloc, A2>&)
+	{
+		return true;
+	}
+
+	template<class T1, size_t A1, class T2, size_t A2, class Alloc>
+	inline bool operator!=(const allocator<T1, Alloc, A1>&, const allocator<T2, Alloc, A2>&)
+	{
+		return false;
+	}
+
+	template<class T, class Alloc, size_t Align>
+	void* allocator<T, Alloc, Align>::raw_allocate(size_t bytes, true_type)
+	{
+		char* raw = static_cast<char*>(raw_alloc::allocate(bytes + overhead));
+		uintptr_t p = ((uintptr_t)raw + sizeof(void*) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		((void**)p)[-1] = raw;
+		return (void*)p;
+	}
+
+	//the offset from the raw block may change, so an over-aligned block is always moved
+	template<class T, class Alloc, size_t Align>
+	void* allocator<T, Alloc, Align>::raw_reallocate(void* p, size_t old_bytes, size_t new_bytes, true_type)
+	{
+		void* res = raw_allocate(new_bytes, true_type());
+		memcpy(res, p, old_bytes < new_bytes ? old_bytes : new_bytes);
+		raw_deallocate(p, old_bytes, true_type());
+		return res;
+	}
+
+	template<class T, class Alloc, size_t Align>
+	T* allocator<T, Alloc, Align>::allocate()
 	{
-		return static_cast<T*>(default_alloc::allocate(sizeof(T)));
+		return static_cast<T*>(raw_allocate(sizeof(T), over_aligned()));
 	}
 
-	template<class T>
-	T* allocator<T>::allocate(size_t n)
+	template<class T, class Alloc, size_t Align>
+	T* allocator<T, Alloc, Align>::allocate(size_t n)
 	{
 		if(n == 0)
 			return nullptr;
-		return static_cast<T*>(default_alloc::allocate(sizeof(T) * n));
+		return static_cast<T*>(raw_allocate(sizeof(T) * n, over_aligned()));
 	}
 
-	template<class T>
-	void allocator<T>::deallocate(T* p)
+	template<class T, class Alloc, size_t Align>
+	void allocator<T, Alloc, Align>::deallocate(T* p)
 	{
-		default_alloc::deallocate(static_cast<void*>(p), sizeof(T));
+		raw_deallocate(static_cast<void*>(p), sizeof(T), over_aligned());
 	}
 
-	template<class T>
-	void allocator<T>::deallocate(T* p, size_t n)
+	template<class T, class Alloc, size_t Align>
+	void allocator<T, Alloc, Align>::deallocate(T* p, size_t n)
 	{
 		if(n == 0)
 			return;
-		default_alloc::deallocate(static_cast<void*>(p), sizeof(T) * n);
+		raw_deallocate(static_cast<void*>(p), sizeof(T) * n, over_aligned());
+	}
+
+	//moves the bytes of old_n objects, so only for trivially relocatable T
+	template<class T, class Alloc, size_t Align>
+	T* allocator<T, Alloc, Align>::reallocate(T* p, size_t old_n, size_t new_n)
+	{
+		return static_cast<T*>(raw_reallocate(static_cast<void*>(p), sizeof(T) * old_n, sizeof(T) * new_n, over_aligned()));
 	}
 
-	template<class T>
-	void allocator<T>::construct(T* p)
+	template<class T, class Alloc, size_t Align>
+	void allocator<T, Alloc, Align>::construct(T* p)
 	{
 		new (p) T();
 	}
 
-	template<class T>
-	void allocator<T>::construct(T* p, const T& v)
+	template<class T, class Alloc, size_t Align>
+	void allocator<T, Alloc, Align>::construct(T* p, const T& v)
 	{
 		new (p) T(v);
 	}
 
-	template<class T>
-	void allocator<T>::destroy(T* p)
+	template<class T, class Alloc, size_t Align>
+	void allocator<T, Alloc, Align>::destroy(T* p)
 	{
 		p->~T();
 	}
 
-	template<class T>
-	void allocator<T>::destroy(T* first, T* last)
+	template<class T, class Alloc, size_t Align>
+	void allocator<T, Alloc, Align>::destroy(T* first, T* last)
 	{
 		while(first != last)
 		{
@@ -84,4 +153,4 @@ namespace grtw
 	}
 }
 
-#endif
\ No newline at end of file
+#endif
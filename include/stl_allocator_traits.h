@@ -0,0 +1,43 @@
+#ifndef GRTW_STL_ALLOCATOR_TRAITS_H
+#define GRTW_STL_ALLOCATOR_TRAITS_H
+
+#include<cstddef>
+#include"type_traits.h"
+
+namespace grtw
+{
+	//true_type if Alloc has reallocate(pointer, old_n, new_n)
+	template<class Alloc>
+	struct alloc_has_reallocate
+	{
+	private:
+		template<class A>
+		static true_type test(decltype(static_cast<A*>(nullptr)->reallocate(typename A::pointer(), size_t(), size_t()))*);
+		template<class A>
+		static false_type test(...);
+
+	public:
+		using type = decltype(test<Alloc>(nullptr));
+	};
+
+	//allocator_traits: containers allocate through an allocator object via this layer, so an
+	//allocator may be a stateless class with static members or an instance carrying state
+	template<class Alloc>
+	struct allocator_traits
+	{
+		using allocator_type = Alloc;
+		using value_type = typename Alloc::value_type;
+		using pointer = typename Alloc::pointer;
+		using size_type = typename Alloc::size_type;
+		using difference_type = typename Alloc::difference_type;
+		using has_reallocate = typename alloc_has_reallocate<Alloc>::type;
+
+		static pointer allocate(Alloc& a, size_type n) { return a.allocate(n); }
+		static void deallocate(Alloc& a, pointer p, size_type n) { a.deallocate(p, n); }
+		static pointer reallocate(Alloc& a, pointer p, size_type old_n, size_type new_n) { return a.reallocate(p, old_n, new_n); }
+
+		static Alloc select_on_container_copy_construction(const Alloc& a) { return a; }
+	};
+}
+
+#endif
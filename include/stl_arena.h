@@ -0,0 +1,202 @@
+#ifndef GRTW_STL_ARENA_H
+#define GRTW_STL_ARENA_H
+
+#include<cstddef>
+#include<cstdint>
+#include<cstring>
+#include"stl_alloc.h"
+
+namespace grtw
+{
+	//monotonic_arena: bump-pointer allocation out of malloc'd blocks,
+	//deallocate is a no-op and everything is given back at once by release()/reset()
+	class monotonic_arena
+	{
+	public:
+		explicit monotonic_arena(size_t initial_block = 4096);
+		~monotonic_arena();
+
+		monotonic_arena(const monotonic_arena&) = delete;
+		monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+		void* allocate(size_t n, size_t align = alignof(std::max_align_t))
+		{
+			uintptr_t p = ((uintptr_t)current + align - 1) & ~(uintptr_t)(align - 1);
+			if(p <= (uintptr_t)limit && n <= (uintptr_t)limit - p)
+			{
+				current = (char*)p + n;
+				return (void*)p;
+			}
+			return allocate_slow(n, align);
+		}
+
+		void deallocate(void*, size_t) {}
+
+		void release();
+		void reset();
+		size_t bytes_reserved() const { return reserved; }
+
+	private:
+		struct block
+		{
+			block* prev;
+			size_t size;
+		};
+
+		enum { MAX_BLOCK = 1 << 20 };
+
+		void* allocate_slow(size_t, size_t);
+		static size_t header_size() { return (sizeof(block) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1); }
+		static char* block_begin(block* b) { return (char*)b + header_size(); }
+
+		char* current;
+		char* limit;
+		block* blocks;
+		size_t initial_size;
+		size_t next_size;
+		size_t reserved;
+	};
+
+	monotonic_arena::monotonic_arena(size_t initial_block)
+		: current(nullptr), limit(nullptr), blocks(nullptr), initial_size(initial_block), next_size(initial_block), reserved(0)
+	{}
+
+	monotonic_arena::~monotonic_arena()
+	{
+		release();
+	}
+
+	void* monotonic_arena::allocate_slow(size_t n, size_t align)
+	{
+		size_t need = header_size() + n + (align > alignof(std::max_align_t) ? align : 0);
+		bool dedicated = n > next_size / 2;
+		size_t size = dedicated ? need : next_size;
+		if(size < need)
+			size = need;
+
+		block* b = (block*)malloc_alloc::allocate(size);
+		b->size = size;
+		reserved += size;
+		uintptr_t p = ((uintptr_t)block_begin(b) + align - 1) & ~(uintptr_t)(align - 1);
+
+		//oversized requests get a block of their own behind the current one, so the rest of
+		//the current block stays usable
+		if(dedicated && blocks != nullptr)
+		{
+			b->prev = blocks->prev;
+			blocks->prev = b;
+			return (void*)p;
+		}
+
+		b->prev = blocks;
+		blocks = b;
+		current = (char*)p + n;
+		limit = (char*)b + size;
+		if(!dedicated && next_size < MAX_BLOCK)
+			next_size *= 2;
+		return (void*)p;
+	}
+
+	void monotonic_arena::release()
+	{
+		while(blocks != nullptr)
+		{
+			block* prev = blocks->prev;
+			malloc_alloc::deallocate(blocks, blocks->size);
+			blocks = prev;
+		}
+		current = nullptr;
+		limit = nullptr;
+		next_size = initial_size;
+		reserved = 0;
+	}
+
+	//like release, but keeps the newest block to serve the next round of allocations
+	void monotonic_arena::reset()
+	{
+		if(blocks == nullptr)
+			return;
+		block* keep = blocks;
+		blocks = blocks->prev;
+		size_t keep_next = next_size;
+		release();
+		keep->prev = nullptr;
+		blocks = keep;
+		current = block_begin(keep);
+		limit = (char*)keep + keep->size;
+		reserved = keep->size;
+		next_size = keep_next;
+	}
+
+	//monotonic_alloc: raw allocator over a per-thread monotonic_arena, for use as
+	//allocator<T, monotonic_alloc<>>; release() frees everything the calling thread allocated
+	template<int inst = 0>
+	class monotonic_alloc
+	{
+	public:
+		static const size_t alignment = alignof(std::max_align_t);
+
+		static void* allocate(size_t n) { return arena().allocate(n); }
+		static void deallocate(void*, size_t) {}
+		static void* reallocate(void*, size_t, size_t);
+
+		static void release() { arena().release(); }
+		static void reset() { arena().reset(); }
+
+		static monotonic_arena& arena()
+		{
+			static thread_local monotonic_arena a;
+			return a;
+		}
+	};
+
+	template<int inst>
+	void* monotonic_alloc<inst>::reallocate(void* p, size_t old_size, size_t new_size)
+	{
+		void* res = allocate(new_size);
+		if(p != nullptr)
+			memcpy(res, p, old_size < new_size ? old_size : new_size);
+		return res;
+	}
+
+	//arena_allocator: stateful allocator drawing from a caller-owned monotonic_arena, so a
+	//container can be pointed at an arena whose lifetime matches the work it does
+	template<class T>
+	class arena_allocator
+	{
+	public:
+		using value_type = T;
+		using pointer = T*;
+		using const_pointer = const T*;
+		using reference = T&;
+		using const_reference = const T&;
+		using size_type = size_t;
+		using difference_type = ptrdiff_t;
+
+		explicit arena_allocator(monotonic_arena& a) : res(&a) {}
+		template<class U>
+		arena_allocator(const arena_allocator<U>& other) : res(other.resource()) {}
+
+		T* allocate(size_t n) { return n == 0 ? nullptr : static_cast<T*>(res->allocate(sizeof(T) * n, alignof(T))); }
+		void deallocate(T*, size_t) {}
+
+		monotonic_arena* resource() const { return res; }
+
+	private:
+		monotonic_arena* res;
+	};
+
+	template<class T1, class T2>
+	inline bool operator==(const arena_allocator<T1>& a, const arena_allocator<T2>& b)
+	{
+		return a.resource() == b.resource();
+	}
+
+	template<class T1, class T2>
+	inline bool operator!=(const arena_allocator<T1>& a, const arena_allocator<T2>& b)
+	{
+		return a.resource() != b.resource();
+	}
+}
+
+#endif
@@ -0,0 +1,370 @@
+#ifndef GRTW_STL_BVECTOR_H
+#define GRTW_STL_BVECTOR_H
+
+#include<cstddef>
+#include<cstdint>
+#include"stl_iterator_base.h"
+#include"stl_iterator.h"
+#include"stl_allocator.h"
+#include"stl_vector.h"
+#include"stl_algorithms.h"
+
+namespace grtw
+{
+	using bit_word = uint64_t;
+	static const size_t bit_word_size = 64;
+
+	//proxy for one bit: the word it lives in and a mask
+	class bit_reference
+	{
+	public:
+		bit_reference(bit_word* w, bit_word m) : word(w), mask(m) {}
+
+		operator bool() const { return (*word & mask) != 0; }
+
+		bit_reference& operator=(bool x)
+		{
+			if(x)
+				*word |= mask;
+			else
+				*word &= ~mask;
+			return *this;
+		}
+
+		bit_reference& operator=(const bit_reference& x) { return *this = bool(x); }
+
+		void flip() { *word ^= mask; }
+
+	private:
+		bit_word* word;
+		bit_word mask;
+	};
+
+	inline void swap(bit_reference a, bit_reference b)
+	{
+		bool tmp = a;
+		a = b;
+		b = tmp;
+	}
+
+	//Word is bit_word for iterator and const bit_word for const_iterator, Reference is
+	//bit_reference or bool
+	template<class Word, class Reference>
+	class Bit_iterator
+	{
+	public:
+		using iterator_category = random_access_iterator_tag;
+		using value_type = bool;
+		using difference_type = ptrdiff_t;
+		using pointer = void;
+		using reference = Reference;
+
+		using self = Bit_iterator<Word, Reference>;
+
+	public:
+		Word* word;
+		unsigned offset;
+
+	public:
+		Bit_iterator() : word(nullptr), offset(0) {}
+		Bit_iterator(Word* w, unsigned off) : word(w), offset(off) {}
+		Bit_iterator(const Bit_iterator<bit_word, bit_reference>& x) : word(x.word), offset(x.offset) {}
+
+		reference operator*() const { return deref(word, bit_word(1) << offset); }
+		reference operator[](difference_type n) const { return *(*this + n); }
+
+		self& operator++()
+		{
+			if(++offset == bit_word_size)
+			{
+				offset = 0;
+				++word;
+			}
+			return *this;
+		}
+
+		self operator++(int)
+		{
+			self tmp = *this;
+			++*this;
+			return tmp;
+		}
+
+		self& operator--()
+		{
+			if(offset-- == 0)
+			{
+				offset = bit_word_size - 1;
+				--word;
+			}
+			return *this;
+		}
+
+		self operator--(int)
+		{
+			self tmp = *this;
+			--*this;
+			return tmp;
+		}
+
+		self& operator+=(difference_type n)
+		{
+			difference_type pos = difference_type(offset) + n;
+			difference_type words = pos / difference_type(bit_word_size);
+			if(pos % difference_type(bit_word_size) < 0)
+				--words;
+			word += words;
+			offset = unsigned(pos - words * difference_type(bit_word_size));
+			return *this;
+		}
+
+		self& operator-=(difference_type n) { return *this += -n; }
+		self operator+(difference_type n) const { self tmp = *this; return tmp += n; }
+		self operator-(difference_type n) const { self tmp = *this; return tmp -= n; }
+
+		difference_type operator-(const self& x) const
+		{
+			return (word - x.word) * difference_type(bit_word_size) + difference_type(offset) - difference_type(x.offset);
+		}
+
+		bool operator==(const self& x) const { return word == x.word && offset == x.offset; }
+		bool operator!=(const self& x) const { return !(*this == x); }
+		bool operator<(const self& x) const { return word < x.word || (word == x.word && offset < x.offset); }
+		bool operator>(const self& x) const { return x < *this; }
+		bool operator<=(const self& x) const { return !(x < *this); }
+		bool operator>=(const self& x) const { return !(*this < x); }
+
+	private:
+		static bit_reference deref(bit_word* w, bit_word m) { return bit_reference(w, m); }
+		static bool deref(const bit_word* w, bit_word m) { return (*w & m) != 0; }
+	};
+
+	//bit_vector: one bit per element in 64-bit words. Bits past size() in the last word are
+	//kept zero, so fill, count, find and the bitwise operators work a whole word at a time
+	template<class Alloc = default_alloc>
+	class bit_vector
+	{
+	public:
+		using value_type = bool;
+		using size_type = size_t;
+		using difference_type = ptrdiff_t;
+		using reference = bit_reference;
+		using const_reference = bool;
+		using iterator = Bit_iterator<bit_word, bit_reference>;
+		using const_iterator = Bit_iterator<const bit_word, bool>;
+		using reverse_iterator = Reverse_iterator<iterator>;
+		using const_reverse_iterator = Reverse_iterator<const_iterator>;
+
+		static const size_type npos = size_type(-1);
+
+	private:
+		vector<bit_word, allocator<bit_word, Alloc> > words;
+		size_type nbits;
+
+		static size_type words_for(size_type n) { return (n + bit_word_size - 1) / bit_word_size; }
+		static bit_word bit_mask(size_type pos) { return bit_word(1) << (pos % bit_word_size); }
+
+		//clears the bits of the last word that are past size()
+		void trim()
+		{
+			size_type tail = nbits % bit_word_size;
+			if(tail != 0)
+				words.back() &= (bit_word(1) << tail) - 1;
+		}
+
+	public:
+		bit_vector() : nbits(0) {}
+
+		explicit bit_vector(size_type n, bool v = false) : words(words_for(n), v ? ~bit_word(0) : bit_word(0)), nbits(n)
+		{
+			trim();
+		}
+
+		iterator begin() { return iterator(words.begin(), 0); }
+		iterator end() { return begin() + nbits; }
+		const_iterator begin() const { return const_iterator(words.begin(), 0); }
+		const_iterator end() const { return begin() + nbits; }
+		const_iterator cbegin() const { return begin(); }
+		const_iterator cend() const { return end(); }
+		reverse_iterator rbegin() { return reverse_iterator(end()); }
+		reverse_iterator rend() { return reverse_iterator(begin()); }
+		const_reverse_iterator crbegin() const { return const_reverse_iterator(end()); }
+		const_reverse_iterator crend() const { return const_reverse_iterator(begin()); }
+
+		bool empty() const { return nbits == 0; }
+		size_type size() const { return nbits; }
+		size_type capacity() const { return words.capacity() * bit_word_size; }
+
+		reference operator[](size_type n) { return reference(&words[n / bit_word_size], bit_mask(n)); }
+		const_reference operator[](size_type n) const { return (words[n / bit_word_size] & bit_mask(n)) != 0; }
+		reference front() { return (*this)[0]; }
+		reference back() { return (*this)[nbits - 1]; }
+		const_reference front() const { return (*this)[0]; }
+		const_reference back() const { return (*this)[nbits - 1]; }
+
+		//the packed words, bit i of the vector is bit i % 64 of word i / 64
+		bit_word* data() { return words.begin(); }
+		const bit_word* data() const { return words.begin(); }
+		size_type word_count() const { return words.size(); }
+
+		void swap(bit_vector& other) noexcept
+		{
+			words.swap(other.words);
+			grtw::swap(nbits, other.nbits);
+		}
+
+		void reserve(size_type n) { words.reserve(words_for(n)); }
+
+		void push_back(bool x)
+		{
+			if(nbits % bit_word_size == 0)
+				words.push_back(bit_word(0));
+			if(x)
+				words.back() |= bit_mask(nbits);
+			++nbits;
+		}
+
+		void pop_back()
+		{
+			--nbits;
+			if(nbits % bit_word_size == 0)
+				words.pop_back();
+			else
+				trim();
+		}
+
+		void resize(size_type n, bool v = false)
+		{
+			size_type old = nbits;
+			words.resize(words_for(n), v ? ~bit_word(0) : bit_word(0));
+			nbits = n;
+			if(v && n > old && old % bit_word_size != 0)
+				words[old / bit_word_size] |= ~bit_word(0) << (old % bit_word_size);
+			trim();
+		}
+
+		void clear()
+		{
+			words.clear();
+			nbits = 0;
+		}
+
+		void fill(bool v)
+		{
+			grtw::fill(words.begin(), words.end(), v ? ~bit_word(0) : bit_word(0));
+			trim();
+		}
+
+		void flip()
+		{
+			for(size_type i = 0; i < words.size(); ++i)
+				words[i] = ~words[i];
+			trim();
+		}
+
+		//number of set bits
+		size_type count() const
+		{
+			size_type res = 0;
+			for(size_type i = 0; i < words.size(); ++i)
+				res += __builtin_popcountll(words[i]);
+			return res;
+		}
+
+		bool any() const
+		{
+			for(size_type i = 0; i < words.size(); ++i)
+				if(words[i] != 0)
+					return true;
+			return false;
+		}
+
+		bool none() const { return !any(); }
+
+		//index of the first set bit at or after pos, npos if there is none
+		size_type find_next(size_type pos) const
+		{
+			if(pos >= nbits)
+				return npos;
+			size_type i = pos / bit_word_size;
+			bit_word w = words[i] & (~bit_word(0) << (pos % bit_word_size));
+			while(w == 0)
+			{
+				if(++i == words.size())
+					return npos;
+				w = words[i];
+			}
+			return i * bit_word_size + __builtin_ctzll(w);
+		}
+
+		size_type find_first() const { return find_next(0); }
+
+		//the bitwise operators work on the common prefix; bits of the shorter operand's
+		//missing tail count as zero
+		bit_vector& operator&=(const bit_vector& other)
+		{
+			size_type n = words.size() < other.words.size() ? words.size() : other.words.size();
+			bit_word* w = words.begin();
+			const bit_word* o = other.words.begin();
+			for(size_type i = 0; i < n; ++i)
+				w[i] &= o[i];
+			grtw::fill(w + n, words.end(), bit_word(0));
+			return *this;
+		}
+
+		bit_vector& operator|=(const bit_vector& other)
+		{
+			size_type n = words.size() < other.words.size() ? words.size() : other.words.size();
+			bit_word* w = words.begin();
+			const bit_word* o = other.words.begin();
+			for(size_type i = 0; i < n; ++i)
+				w[i] |= o[i];
+			trim();
+			return *this;
+		}
+
+		bit_vector& operator^=(const bit_vector& other)
+		{
+			size_type n = words.size() < other.words.size() ? words.size() : other.words.size();
+			bit_word* w = words.begin();
+			const bit_word* o = other.words.begin();
+			for(size_type i = 0; i < n; ++i)
+				w[i] ^= o[i];
+			trim();
+			return *this;
+		}
+
+		bool operator==(const bit_vector& other) const
+		{
+			return nbits == other.nbits && grtw::equal(words.begin(), words.end(), other.words.begin());
+		}
+
+		bool operator!=(const bit_vector& other) const { return !(*this == other); }
+	};
+
+	template<class Alloc>
+	inline bit_vector<Alloc> operator&(const bit_vector<Alloc>& a, const bit_vector<Alloc>& b)
+	{
+		bit_vector<Alloc> res(a);
+		res &= b;
+		return res;
+	}
+
+	template<class Alloc>
+	inline bit_vector<Alloc> operator|(const bit_vector<Alloc>& a, const bit_vector<Alloc>& b)
+	{
+		bit_vector<Alloc> res(a);
+		res |= b;
+		return res;
+	}
+
+	template<class Alloc>
+	inline bit_vector<Alloc> operator^(const bit_vector<Alloc>& a, const bit_vector<Alloc>& b)
+	{
+		bit_vector<Alloc> res(a);
+		res ^= b;
+		return res;
+	}
+}
+
+#endif
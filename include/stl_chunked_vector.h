@@ -0,0 +1,340 @@
+#ifndef GRTW_STL_CHUNKED_VECTOR_H
+#define GRTW_STL_CHUNKED_VECTOR_H
+
+#include<cstddef>
+#include"stl_iterator.h"
+#include"stl_construct.h"
+#include"stl_allocator.h"
+#include"stl_allocator_traits.h"
+#include"stl_uninitialized.h"
+#include"stl_vector.h"
+#include"stl_utility.h"
+
+namespace grtw
+{
+	inline constexpr size_t chunk_floor_pow2(size_t n, size_t p = 1)
+	{
+		return p * 2 > n ? p : chunk_floor_pow2(n, p * 2);
+	}
+
+	inline constexpr size_t chunk_log2(size_t n)
+	{
+		return n <= 1 ? 0 : 1 + chunk_log2(n >> 1);
+	}
+
+	//elements per chunk: 4KB worth rounded down to a power of two, at least 16
+	inline constexpr size_t chunk_default_size(size_t size)
+	{
+		return size * 16 >= 4096 ? 16 : chunk_floor_pow2(4096 / size);
+	}
+
+	//the position is an index into the chunk table, so finding the element is a shift and a
+	//mask; the table is reallocated when chunks are added, which invalidates iterators
+	template<class T, class Reference, class Pointer, size_t ChunkSize>
+	struct chunked_iterator
+	{
+		using iterator_category = random_access_iterator_tag;
+		using value_type = T;
+		using difference_type = ptrdiff_t;
+		using reference = Reference;
+		using pointer = Pointer;
+
+		using Self = chunked_iterator<T, Reference, Pointer, ChunkSize>;
+		using iterator = chunked_iterator<T, T&, T*, ChunkSize>;
+
+		static const size_t shift = chunk_log2(ChunkSize);
+		static const size_t mask = ChunkSize - 1;
+
+		T* const* chunks;
+		size_t index;
+
+		chunked_iterator() : chunks(nullptr), index(0) {}
+		chunked_iterator(T* const* c, size_t i) : chunks(c), index(i) {}
+		chunked_iterator(const iterator& x) : chunks(x.chunks), index(x.index) {}
+
+		reference operator*() const { return chunks[index >> shift][index & mask]; }
+		pointer operator->() const { return &**this; }
+		reference operator[](difference_type n) const { return *(*this + n); }
+
+		Self& operator++()
+		{
+			++index;
+			return *this;
+		}
+
+		Self operator++(int)
+		{
+			Self tmp = *this;
+			++index;
+			return tmp;
+		}
+
+		Self& operator--()
+		{
+			--index;
+			return *this;
+		}
+
+		Self operator--(int)
+		{
+			Self tmp = *this;
+			--index;
+			return tmp;
+		}
+
+		Self& operator+=(difference_type n)
+		{
+			index += n;
+			return *this;
+		}
+
+		Self& operator-=(difference_type n)
+		{
+			index -= n;
+			return *this;
+		}
+
+		Self operator+(difference_type n) const { return Self(chunks, index + n); }
+		Self operator-(difference_type n) const { return Self(chunks, index - n); }
+		difference_type operator-(const Self& x) const { return difference_type(index) - difference_type(x.index); }
+
+		bool operator==(const Self& other) const { return index == other.index; }
+		bool operator!=(const Self& other) const { return index != other.index; }
+		bool operator<(const Self& other) const { return index < other.index; }
+		bool operator>(const Self& other) const { return other.index < index; }
+		bool operator<=(const Self& other) const { return !(other.index < index); }
+		bool operator>=(const Self& other) const { return !(index < other.index); }
+	};
+
+	template<class T, class Reference, class Pointer, size_t ChunkSize>
+	const size_t chunked_iterator<T, Reference, Pointer, ChunkSize>::shift;
+
+	template<class T, class Reference, class Pointer, size_t ChunkSize>
+	const size_t chunked_iterator<T, Reference, Pointer, ChunkSize>::mask;
+
+	//chunked_vector: elements live in fixed chunks of ChunkSize (a power of two) that are never
+	//moved or freed while in use, so growing copies only the table of chunk pointers and the
+	//address of an element stays valid until it is erased; indexing is a shift and a mask
+	template<class T, size_t ChunkSize = chunk_default_size(sizeof(T)), class Alloc = allocator<T> >
+	class chunked_vector
+	{
+		static_assert(ChunkSize != 0 && (ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+
+	public:
+		using value_type = T;
+		using pointer = T*;
+		using const_pointer = const T*;
+		using reference = T&;
+		using const_reference = const T&;
+		using size_type = size_t;
+		using difference_type = ptrdiff_t;
+		using allocator_type = Alloc;
+
+		using iterator = chunked_iterator<T, T&, T*, ChunkSize>;
+		using const_iterator = chunked_iterator<T, const T&, const T*, ChunkSize>;
+		using reverse_iterator = Reverse_iterator<iterator>;
+		using const_reverse_iterator = Reverse_iterator<const_iterator>;
+
+		static const size_type chunk_size = ChunkSize;
+
+	private:
+		using alloc_traits = allocator_traits<Alloc>;
+
+		static const size_type shift = chunk_log2(ChunkSize);
+		static const size_type mask = ChunkSize - 1;
+
+		//the allocator is a base of the storage, so a stateless one takes no space
+		struct storage : public Alloc
+		{
+			vector<T*> chunks;
+			size_type count;
+
+			storage(const Alloc& a) : Alloc(a), count(0) {}
+		};
+
+		storage impl;
+
+		T* slot(size_type n) const { return impl.chunks[n >> shift] + (n & mask); }
+
+		//makes sure slot count exists, adding one chunk when the last one is full
+		void make_room()
+		{
+			if(impl.count == capacity())
+				impl.chunks.push_back(alloc_traits::allocate(impl, ChunkSize));
+		}
+
+		void free_chunks(size_type keep)
+		{
+			while(impl.chunks.size() > keep)
+			{
+				alloc_traits::deallocate(impl, impl.chunks.back(), ChunkSize);
+				impl.chunks.pop_back();
+			}
+		}
+
+		void destroy_from(size_type n)
+		{
+			for(; impl.count > n; --impl.count)
+				grtw::destroy(slot(impl.count - 1));
+		}
+
+		void append(const chunked_vector& other)
+		{
+			reserve(impl.count + other.size());
+			for(size_type i = 0; i < other.size(); ++i)
+			{
+				grtw::construct(slot(impl.count), other[i]);
+				++impl.count;
+			}
+		}
+
+	public:
+		chunked_vector() : impl(Alloc()) {}
+
+		explicit chunked_vector(const Alloc& a) : impl(a) {}
+
+		explicit chunked_vector(size_type n, const Alloc& a = Alloc()) : impl(a)
+		{
+			resize(n);
+		}
+
+		chunked_vector(size_type n, const T& v, const Alloc& a = Alloc()) : impl(a)
+		{
+			resize(n, v);
+		}
+
+		chunked_vector(const chunked_vector& other) : impl(alloc_traits::select_on_container_copy_construction(other.impl))
+		{
+			append(other);
+		}
+
+		chunked_vector(chunked_vector&& other) noexcept : impl(grtw::move(other.impl))
+		{
+			other.impl.count = 0;
+		}
+
+		chunked_vector& operator=(const chunked_vector& other)
+		{
+			if(this != &other)
+			{
+				clear();
+				append(other);
+			}
+			return *this;
+		}
+
+		chunked_vector& operator=(chunked_vector&& other) noexcept
+		{
+			chunked_vector tmp(grtw::move(other));
+			swap(tmp);
+			return *this;
+		}
+
+		~chunked_vector()
+		{
+			clear();
+			free_chunks(0);
+		}
+
+		allocator_type get_allocator() const { return impl; }
+
+		void swap(chunked_vector& other) noexcept { grtw::swap(impl, other.impl); }
+
+		iterator begin() { return iterator(impl.chunks.begin(), 0); }
+		iterator end() { return iterator(impl.chunks.begin(), impl.count); }
+		const_iterator begin() const { return const_iterator(impl.chunks.begin(), 0); }
+		const_iterator end() const { return const_iterator(impl.chunks.begin(), impl.count); }
+		const_iterator cbegin() const { return begin(); }
+		const_iterator cend() const { return end(); }
+		reverse_iterator rbegin() { return reverse_iterator(end()); }
+		reverse_iterator rend() { return reverse_iterator(begin()); }
+		const_reverse_iterator crbegin() const { return const_reverse_iterator(end()); }
+		const_reverse_iterator crend() const { return const_reverse_iterator(begin()); }
+
+		bool empty() const { return impl.count == 0; }
+		size_type size() const { return impl.count; }
+		size_type capacity() const { return impl.chunks.size() * ChunkSize; }
+
+		reference operator[](size_type n) { return *slot(n); }
+		const_reference operator[](size_type n) const { return *slot(n); }
+		reference front() { return *slot(0); }
+		reference back() { return *slot(impl.count - 1); }
+		const_reference front() const { return *slot(0); }
+		const_reference back() const { return *slot(impl.count - 1); }
+
+		//allocates the chunks for n elements up front
+		void reserve(size_type n)
+		{
+			size_type chunks = (n + ChunkSize - 1) >> shift;
+			impl.chunks.reserve(chunks);
+			while(impl.chunks.size() < chunks)
+				impl.chunks.push_back(alloc_traits::allocate(impl, ChunkSize));
+		}
+
+		//frees the chunks past the last element
+		void shrink_to_fit()
+		{
+			free_chunks((impl.count + ChunkSize - 1) >> shift);
+			impl.chunks.shrink_to_fit();
+		}
+
+		void push_back(const T& v) { emplace_back(v); }
+		void push_back(T&& v) { emplace_back(grtw::move(v)); }
+
+		template<class... Args>
+		reference emplace_back(Args&&... args)
+		{
+			make_room();
+			T* p = slot(impl.count);
+			grtw::construct(p, grtw::forward<Args>(args)...);
+			++impl.count;
+			return *p;
+		}
+
+		void pop_back()
+		{
+			--impl.count;
+			grtw::destroy(slot(impl.count));
+		}
+
+		void resize(size_type n, const T& v)
+		{
+			if(n < impl.count)
+				destroy_from(n);
+			else
+			{
+				reserve(n);
+				for(; impl.count < n; ++impl.count)
+					grtw::construct(slot(impl.count), v);
+			}
+		}
+
+		void resize(size_type n) { resize(n, T()); }
+
+		//destroys the elements and keeps the chunks for reuse
+		void clear() { destroy_from(0); }
+
+		bool operator==(const chunked_vector& other) const
+		{
+			if(size() != other.size())
+				return false;
+			for(size_type i = 0; i < size(); ++i)
+				if(!((*this)[i] == other[i]))
+					return false;
+			return true;
+		}
+
+		bool operator!=(const chunked_vector& other) const { return !(*this == other); }
+	};
+
+	template<class T, size_t ChunkSize, class Alloc>
+	const size_t chunked_vector<T, ChunkSize, Alloc>::chunk_size;
+
+	template<class T, size_t ChunkSize, class Alloc>
+	const size_t chunked_vector<T, ChunkSize, Alloc>::shift;
+
+	template<class T, size_t ChunkSize, class Alloc>
+	const size_t chunked_vector<T, ChunkSize, Alloc>::mask;
+}
+
+#endif
@@ -3,20 +3,16 @@
 
 #include<new>
 #include"type_traits.h"
+#include"stl_iterator_base.h"
+#include"stl_utility.h"
 
 namespace grtw
 {
-	//construct : placement new
-	template<class T1, class T2>
-	inline void construct(T1* p, T2& value)
+	//construct : placement new, forwarding the arguments to T's constructor
+	template<class T, class... Args>
+	inline void construct(T* p, Args&&... args)
 	{
-		new ((void*)p) (T1)(value);
-	}
-
-	template<class T>
-	inline void construct(T* p)
-	{
-		new ((void*)p) T();
+		new ((void*)p) T(grtw::forward<Args>(args)...);
 	}
 
 	//destroy
@@ -30,7 +26,7 @@ namespace grtw
 	void __destroy(Iterator first, Iterator last, false_type)
 	{
 		for(; first != last; first++)
-			destroy(&*first);
+			grtw::destroy(&*first);
 	}
 
 	template<class Iterator>
@@ -4,8 +4,10 @@
 #include"stl_iterator.h"
 #include"stl_construct.h"
 #include"stl_allocator.h"
+#include"stl_allocator_traits.h"
 #include"stl_algorithms.h"
 #include"stl_uninitialized.h"
+#include"stl_utility.h"
 
 namespace grtw
 {
@@ -116,7 +118,7 @@ namespace grtw
 			return tmp -= n;
 		}
 
-		reference operator[](difference_type n)
+		reference operator[](difference_type n) const
 		{
 			return *(*this + n);
 		}
@@ -129,12 +131,18 @@ namespace grtw
 		bool operator>=(const Self& other) const { return !(*this < other); }
 	};
 
-	template<class T, class Reference, class Pointer, size_t BufferSize>
-	inline deque_iterator<T, Reference, Pointer, BufferSize> operator+(ptrdiff_t n, const deque_iterator<T>& it)
+	template<class T, class Reference, class Pointer, size_t Nodesize>
+	inline deque_iterator<T, Reference, Pointer, Nodesize> operator+(ptrdiff_t n, const deque_iterator<T, Reference, Pointer, Nodesize>& it)
 	{
 		return it + n;
 	}
 
+	//number of elements per node: 512 bytes worth, at least one
+	inline constexpr size_t deque_buf_size(size_t sz)
+	{
+		return sz < 512 ? 512 / sz : size_t(1);
+	}
+
 	template<class T, class Node_Alloc = allocator<T>, class Map_Alloc = allocator<T*>>
 	class deque
 	{
@@ -147,19 +155,44 @@ namespace grtw
 		using difference_type = ptrdiff_t;
 		using size_type = size_t;
 
-		using iterator = deque_iterator<value_type, reference, pointer, BufferSize()>;
-		using const_iterator = deque_iterator<value_type, const_reference, const_pointer, BufferSize()>;
+		using iterator = deque_iterator<value_type, reference, pointer, deque_buf_size(sizeof(T))>;
+		using const_iterator = deque_iterator<value_type, const_reference, const_pointer, deque_buf_size(sizeof(T))>;
 		using reverse_iterator = Reverse_iterator<iterator>;
 		using const_reverse_iterator = Reverse_iterator<const_iterator>;
+		using allocator_type = Node_Alloc;
 
 	private:
-		value_type** node_map;
-		size_type map_size;
-		iterator start;
-		iterator finish;
+		using node_traits = allocator_traits<Node_Alloc>;
+		using map_traits = allocator_traits<Map_Alloc>;
+		using relocatable = typename Is_trivially_relocatable<T>::Relocatable;
+
+		//each allocator is a base of the storage it manages, so stateless ones take no space
+		struct storage : public Node_Alloc
+		{
+			iterator start;
+			iterator finish;
+
+			storage(const Node_Alloc& a) : Node_Alloc(a), start(), finish() {}
+		};
+
+		struct map_storage : public Map_Alloc
+		{
+			value_type** node_map;
+			size_type map_size;
+
+			map_storage(const Map_Alloc& a) : Map_Alloc(a), node_map(nullptr), map_size(0) {}
+		};
+
+		storage impl;
+		map_storage map_impl;
 
 	private:
-		static size_type BufferSize() { return (sizeof(value_type) < 512) ? (512/(sizeof(value_type))) : size_type(1); }
+		static size_type BufferSize() { return deque_buf_size(sizeof(value_type)); }
+
+		value_type* allocate_node() { return node_traits::allocate(impl, BufferSize()); }
+		void deallocate_node(value_type* p) { node_traits::deallocate(impl, p, BufferSize()); }
+		value_type** allocate_map(size_type n) { return map_traits::allocate(map_impl, n); }
+		void deallocate_map(value_type** p, size_type n) { map_traits::deallocate(map_impl, p, n); }
 
 		void initialize_map(size_type);
 		void create_nodes(value_type**, value_type**);
@@ -168,41 +201,55 @@ namespace grtw
 		void check_map_and_realloc_map_if_not_enough_nodes_at_back(size_type);
 		void check_map_and_realloc_map_if_not_enough_nodes_at_front(size_type);
 		void reallocate_map(size_type, bool);
-		iterator insert_aux(iterator, const value_type&);
+		template<class... Args>
+		iterator emplace_aux(iterator, Args&&...);
 		iterator insert_aux(iterator, size_type, const value_type&);
 		void insert_aux(iterator, const value_type*, const value_type*, size_type);
 		void insert_aux(iterator, const_iterator, const_iterator, size_type);
+		static void relocate(iterator, iterator, iterator);
+		static void relocate_backward(iterator, iterator, iterator);
+		iterator erase_aux(iterator, true_type);
+		iterator erase_aux(iterator, false_type);
+		iterator erase_aux(iterator, iterator, true_type);
+		iterator erase_aux(iterator, iterator, false_type);
 
 	public:
-		deque() : node_map(nullptr), map_size(0), start(), finish() { initialize_map(0); }
-		explicit deque(size_type n) : node_map(nullptr), map_size(0), start(), finish()
+		deque() : impl(Node_Alloc()), map_impl(Map_Alloc()) { initialize_map(0); }
+		explicit deque(const Node_Alloc& a, const Map_Alloc& ma = Map_Alloc()) : impl(a), map_impl(ma) { initialize_map(0); }
+		explicit deque(size_type n, const Node_Alloc& a = Node_Alloc(), const Map_Alloc& ma = Map_Alloc()) : impl(a), map_impl(ma)
 		{
 			initialize_map(n);
 			fill_initialize(value_type());
 		}
 
-		deque(size_type n, const value_type& v) : node_map(nullptr), map_size(0), start(), finish()
+		deque(size_type n, const value_type& v, const Node_Alloc& a = Node_Alloc(), const Map_Alloc& ma = Map_Alloc()) : impl(a), map_impl(ma)
 		{
 			initialize_map(n);
 			fill_initialize(v);
 		}
 
-		deque(const value_type* first, const value_type* last) : node_map(nullptr), map_size(0), start(), finish()
+		deque(const value_type* first, const value_type* last, const Node_Alloc& a = Node_Alloc(), const Map_Alloc& ma = Map_Alloc()) : impl(a), map_impl(ma)
 		{
 			initialize_map(last - first);
-			uninitialized_copy(first, last, start);
+			grtw::uninitialized_copy(first, last, impl.start);
 		}
 
-		deque(const_iterator first, const_iterator last) : node_map(nullptr), map_size(0), start(), finish()
+		deque(const_iterator first, const_iterator last, const Node_Alloc& a = Node_Alloc(), const Map_Alloc& ma = Map_Alloc()) : impl(a), map_impl(ma)
 		{
 			initialize_map(last - first);
-			uninitialized_copy(first, last, start);
+			grtw::uninitialized_copy(first, last, impl.start);
 		}
 
-		deque(const deque& other) : node_map(nullptr), map_size(0), start(), finish()
+		deque(const deque& other)
+			: impl(node_traits::select_on_container_copy_construction(other.impl)), map_impl(map_traits::select_on_container_copy_construction(other.map_impl))
 		{
 			initialize_map(other.size());
-			uninitialized_copy(other.begin(), other.end(), start);
+			grtw::uninitialized_copy(other.begin(), other.end(), impl.start);
+		}
+
+		deque(deque&& other) : impl(other.impl), map_impl(other.map_impl)
+		{
+			other.initialize_map(0);
 		}
 
 		deque& operator=(const deque& other)
@@ -210,57 +257,85 @@ namespace grtw
 			if(&other != this)
 			{
 				if(size() >= other.size())
-					erase(copy(other.begin(), other.end(), start), finish);
+					erase(grtw::copy(other.begin(), other.end(), impl.start), impl.finish);
 				else
 				{
-					iterator mid = other.begin + difference_type(size());
-					copy(other.begin(), mid);
-					insert(finish, mid, other.end());
+					const_iterator mid = other.begin() + difference_type(size());
+					grtw::copy(other.begin(), mid, impl.start);
+					insert(impl.finish, mid, other.end());
 				}
 			}
+			return *this;
+		}
+
+		deque& operator=(deque&& other)
+		{
+			if(&other != this)
+			{
+				clear();
+				swap(other);
+			}
+			return *this;
 		}
 
 		~deque()
 		{
-			destroy(start, finish);
-			destroy_nodes(start.node, finish.node + 1);
-			Map_Alloc::deallocate(node_map, map_size);
+			grtw::destroy(impl.start, impl.finish);
+			destroy_nodes(impl.start.node, impl.finish.node + 1);
+			deallocate_map(map_impl.node_map, map_impl.map_size);
+		}
+
+		allocator_type get_allocator() const { return impl; }
+
+		void swap(deque& other) noexcept
+		{
+			grtw::swap(impl, other.impl);
+			grtw::swap(map_impl, other.map_impl);
 		}
 
-		iterator begin() { return start; }
-		iterator end() { return finish; }
-		const_iterator begin() const { return start; }
-		const_iterator end() const { return finish; }
-		reverse_iterator rbegin() { return reverse_iterator(finish); }
-		reverse_iterator rend() { return reverse_iterator(start); }
-		const_reverse_iterator rbegin() const { return const_reverse_iterator(finish); }
-		const_reverse_iterator rend() const { return const_reverse_iterator(start); }
+		iterator begin() { return impl.start; }
+		iterator end() { return impl.finish; }
+		const_iterator begin() const { return impl.start; }
+		const_iterator end() const { return impl.finish; }
+		reverse_iterator rbegin() { return reverse_iterator(impl.finish); }
+		reverse_iterator rend() { return reverse_iterator(impl.start); }
+		const_reverse_iterator rbegin() const { return const_reverse_iterator(impl.finish); }
+		const_reverse_iterator rend() const { return const_reverse_iterator(impl.start); }
 
-		reference operator[](size_type n) { return start[difference_type(n)]; }
-		const_reference operator[](size_type n) const { return start[difference_type(n)]; }
+		reference operator[](size_type n) { return impl.start[difference_type(n)]; }
+		const_reference operator[](size_type n) const { return impl.start[difference_type(n)]; }
 
-		reference front() { return *start; }
-		const_reference front() const { return *start; }
+		reference front() { return *impl.start; }
+		const_reference front() const { return *impl.start; }
 		reference back()
 		{
-			iterator tmp = finish;
+			iterator tmp = impl.finish;
 			return *(--tmp);
 		}
 		const_reference back() const
 		{
-			const_iterator tmp = finish;
+			const_iterator tmp = impl.finish;
 			return *(--tmp);
 		}
 
-		size_type size() const { return finish - start; }
-		bool empty() const { return finish == start; }
+		size_type size() const { return impl.finish - impl.start; }
+		bool empty() const { return impl.finish == impl.start; }
 
 		void pop_back();
 		void pop_front();
 
-		void push_back(const value_type&);
-		void push_front(const value_type&);
-		iterator insert(iterator, const value_type&);
+		void push_back(const value_type& v) { emplace_back(v); }
+		void push_back(value_type&& v) { emplace_back(grtw::move(v)); }
+		void push_front(const value_type& v) { emplace_front(v); }
+		void push_front(value_type&& v) { emplace_front(grtw::move(v)); }
+		template<class... Args>
+		void emplace_back(Args&&...);
+		template<class... Args>
+		void emplace_front(Args&&...);
+		iterator insert(iterator it, const value_type& v) { return emplace(it, v); }
+		iterator insert(iterator it, value_type&& v) { return emplace(it, grtw::move(v)); }
+		template<class... Args>
+		iterator emplace(iterator, Args&&...);
 		iterator insert(iterator, size_type, const value_type&);
 		void insert(iterator, const value_type*, const value_type*);
 		void insert(iterator, const_iterator, const_iterator);
@@ -274,154 +349,158 @@ namespace grtw
 	void deque<T, Node_Alloc, Map_Alloc>::initialize_map(size_type nelements)
 	{
 		size_type nnodes = nelements/BufferSize() + 1;
-		map_size = max(8, nnodes + 2);
-		node_map = Map_Alloc::allocate(map_size);
-		value_type** nstart = node_map + (map_size - nnodes)/2;
+		map_impl.map_size = grtw::max(size_type(8), nnodes + 2);
+		map_impl.node_map = allocate_map(map_impl.map_size);
+		value_type** nstart = map_impl.node_map + (map_impl.map_size - nnodes)/2;
 		value_type** nfinish = nstart + nnodes;
 		create_nodes(nstart, nfinish);
-		start.set_node(nstart);
-		finish.set_node(nfinish - 1);
-		start.current = start.first;
-		finish.current = finish.first + nelements % BufferSize();
+		impl.start.set_node(nstart);
+		impl.finish.set_node(nfinish - 1);
+		impl.start.current = impl.start.first;
+		impl.finish.current = impl.finish.first + nelements % BufferSize();
 	}
 
 	template<class T, class Node_Alloc, class Map_Alloc>
-	void deque<T, Node_Alloc, Map_Alloc>::create_nodes(value_type** start, value_type** finish)
+	void deque<T, Node_Alloc, Map_Alloc>::create_nodes(value_type** nstart, value_type** nfinish)
 	{
-		for(value_type** curr = start; curr < finish; ++curr)
-			*curr = Node_Alloc::allocate(BufferSize());
+		for(value_type** curr = nstart; curr < nfinish; ++curr)
+			*curr = allocate_node();
 	}
 
 	template<class T, class Node_Alloc, class Map_Alloc>
-	void deque<T, Node_Alloc, Map_Alloc>::destroy_nodes(value_type** start, value_type** finish)
+	void deque<T, Node_Alloc, Map_Alloc>::destroy_nodes(value_type** nstart, value_type** nfinish)
 	{
-		for(value_type** curr = start; curr < finish; ++curr)
-			Node_Alloc::deallocate(*curr, BufferSize());
+		for(value_type** curr = nstart; curr < nfinish; ++curr)
+			deallocate_node(*curr);
 	}
 
 	template<class T, class Node_Alloc, class Map_Alloc>
 	void deque<T, Node_Alloc, Map_Alloc>::fill_initialize(const value_type& v)
 	{
-		for(value_type** curr = start.node;; curr < finish.node; ++curr)
-			uninitialized_fill(*curr, *curr + BufferSize(), v);
-		uninitialized_fill(finish.first, finish.current, v);
+		for(value_type** curr = impl.start.node; curr < impl.finish.node; ++curr)
+			grtw::uninitialized_fill(*curr, *curr + BufferSize(), v);
+		grtw::uninitialized_fill(impl.finish.first, impl.finish.current, v);
 	}
 
 	template<class T, class Node_Alloc, class Map_Alloc>
 	void deque<T, Node_Alloc, Map_Alloc>::reallocate_map(size_type nodes_to_add, bool add_at_front)
 	{
-		size_type old_node_nums = finish.node - start.node + 1;
+		size_type old_node_nums = impl.finish.node - impl.start.node + 1;
 		size_type new_node_nums = old_node_nums + nodes_to_add;
 		value_type** new_start;
-		if(map_size > 2 * new_node_nums)
+		if(map_impl.map_size > 2 * new_node_nums)
 		{
-			new_start = node_map + (map_size - new_node_nums)/2 + (add_at_front ? nodes_to_add : 0);
-			if(new_start < start)
-				copy(start.node, finish.node + 1, new_start.node);
+			new_start = map_impl.node_map + (map_impl.map_size - new_node_nums)/2 + (add_at_front ? nodes_to_add : 0);
+			if(new_start < impl.start.node)
+				grtw::copy(impl.start.node, impl.finish.node + 1, new_start);
 			else
-				copy_backward(start.node, finish.node + 1, new_start + old_node_nums);
+				grtw::copy_backward(impl.start.node, impl.finish.node + 1, new_start + old_node_nums);
 		}
 		else
 		{
-			size_type new_map_size = map_size + max(nodes_to_add, map_size) + 2;
-			value_type** new_map = Map_Alloc::allocate(new_map_size);
+			size_type new_map_size = map_impl.map_size + max(nodes_to_add, map_impl.map_size) + 2;
+			value_type** new_map = allocate_map(new_map_size);
 			new_start = new_map + (new_map_size - new_node_nums)/2 + (add_at_front ? nodes_to_add : 0);
-			copy(start.node, finish.node + 1, new_start);
-			Map_Alloc::deallocate(node_map, map_size);
-			node_map = new_map;
-			map_size = new_map_size;
+			grtw::copy(impl.start.node, impl.finish.node + 1, new_start);
+			deallocate_map(map_impl.node_map, map_impl.map_size);
+			map_impl.node_map = new_map;
+			map_impl.map_size = new_map_size;
 		}
-		start.set_node(new_start);
-		finish.set_node(new_start + old_node_nums - 1);
+		impl.start.set_node(new_start);
+		impl.finish.set_node(new_start + old_node_nums - 1);
 	}
 
 	template<class T, class Node_Alloc, class Map_Alloc>
 	void deque<T, Node_Alloc, Map_Alloc>::check_map_and_realloc_map_if_not_enough_nodes_at_back(size_type nodes_to_add)
 	{
-		if(map_size - (finish.node - node_map) < nodes_to_add + 1)
+		if(map_impl.map_size - (impl.finish.node - map_impl.node_map) < nodes_to_add + 1)
 			reallocate_map(nodes_to_add, false);
 	}
 
 	template<class T, class Node_Alloc, class Map_Alloc>
 	void deque<T, Node_Alloc, Map_Alloc>::check_map_and_realloc_map_if_not_enough_nodes_at_front(size_type nodes_to_add)
 	{
-		if(nodes_to_add > size_type(start.node - node_map))
+		if(nodes_to_add > size_type(impl.start.node - map_impl.node_map))
 			reallocate_map(nodes_to_add, true);
 	}
 
 	template<class T, class Node_Alloc, class Map_Alloc>
-	void deque<T, Node_Alloc, Map_Alloc>::push_back(const value_type& v)
+	template<class... Args>
+	void deque<T, Node_Alloc, Map_Alloc>::emplace_back(Args&&... args)
 	{
-		if(finish.current != finish.last - 1)
-			construct(finish.current, v);
+		if(impl.finish.current != impl.finish.last - 1)
+			grtw::construct(impl.finish.current, grtw::forward<Args>(args)...);
 		else
 		{
 			check_map_and_realloc_map_if_not_enough_nodes_at_back(1);
-			*(finish.node + 1) = Node_Alloc::allocate(BufferSize());
-			construct(finish.current, v);
+			*(impl.finish.node + 1) = allocate_node();
+			grtw::construct(impl.finish.current, grtw::forward<Args>(args)...);
 		}
-		++finish;
+		++impl.finish;
 	}
 
 	template<class T, class Node_Alloc, class Map_Alloc>
-	void deque<T, Node_Alloc, Map_Alloc>::push_front(const value_type& v)
+	template<class... Args>
+	void deque<T, Node_Alloc, Map_Alloc>::emplace_front(Args&&... args)
 	{
-		if(start.current != start.first)
-			construct(start.current - 1, v);
+		if(impl.start.current != impl.start.first)
+			grtw::construct(impl.start.current - 1, grtw::forward<Args>(args)...);
 		else
 		{
 			check_map_and_realloc_map_if_not_enough_nodes_at_front(1);
-			*(start.node - 1) = Node_Alloc::allocate(BufferSize());
-			construct(*(start.node - 1) + BufferSize() - 1, v);
+			*(impl.start.node - 1) = allocate_node();
+			grtw::construct(*(impl.start.node - 1) + BufferSize() - 1, grtw::forward<Args>(args)...);
 		}
-		--start;
+		--impl.start;
 	}
 
 	template<class T, class Node_Alloc, class Map_Alloc>
+	template<class... Args>
 	typename deque<T, Node_Alloc, Map_Alloc>::iterator
-	deque<T, Node_Alloc, Map_Alloc>::insert(iterator it, const value_type& v)
+	deque<T, Node_Alloc, Map_Alloc>::emplace(iterator it, Args&&... args)
 	{
-		if(it == finish)
+		if(it == impl.finish)
 		{
-			push_back(v);
-			return finish - 1;
+			emplace_back(grtw::forward<Args>(args)...);
+			return impl.finish - 1;
 		}
-		else if(it == start)
+		else if(it == impl.start)
 		{
-			push_front(v);
-			return start;
+			emplace_front(grtw::forward<Args>(args)...);
+			return impl.start;
 		}
 		else
 		{
-			return insert_aux(it, v);
+			return emplace_aux(it, grtw::forward<Args>(args)...);
 		}
 	}
 
 	template<class T, class Node_Alloc, class Map_Alloc>
+	template<class... Args>
 	typename deque<T, Node_Alloc, Map_Alloc>::iterator
-	deque<T, Node_Alloc, Map_Alloc>::insert_aux(iterator it, const value_type& v)
+	deque<T, Node_Alloc, Map_Alloc>::emplace_aux(iterator it, Args&&... args)
 	{
-		difference_type index = it - start;
-		value_type v_copy = v;
+		difference_type index = it - impl.start;
+		value_type v_copy(grtw::forward<Args>(args)...);
 		if(size_type(index) < size() / 2)
 		{
-			push_front(front());
-			iterator front1 = start + 1;
+			emplace_front(grtw::move(front()));
+			iterator front1 = impl.start + 1;
 			iterator front2 = front1 + 1;
-			iterator pos = start + index + 1;
-			copy(front2, pos, front1);
-			*pos = v_copy;
+			iterator pos = impl.start + index;
+			grtw::move(front2, pos + 1, front1);
+			*pos = grtw::move(v_copy);
 			return pos;
 		}
 		else
 		{
-			 push_back(back());
-			 iterator back1 = finish - 1;
-			 iterator back2 = back1 - 1;
-			 iterator pos = start + index;
-			 copy_backward(index, back2, back1);
-			 *pos = v_copy;
-			 return pos;
+			emplace_back(grtw::move(back()));
+			iterator back1 = impl.finish - 1;
+			iterator back2 = back1 - 1;
+			iterator pos = impl.start + index;
+			grtw::move_backward(pos, back2, back1);
+			*pos = grtw::move(v_copy);
+			return pos;
 		}
 	}
 
@@ -429,35 +508,35 @@ namespace grtw
 	typename deque<T, Node_Alloc, Map_Alloc>::iterator
 	deque<T, Node_Alloc, Map_Alloc>::insert(iterator it, size_type n, const value_type& v)
 	{
-		if(it == finish)
+		if(it == impl.finish)
 		{
-			size_type vacancies = finish.last - finish.current - 1;
+			size_type vacancies = impl.finish.last - impl.finish.current - 1;
 			if(vacancies < n)
 			{
 				size_type nodes_to_add = (n - vacancies + BufferSize() - 1) / BufferSize();
 				check_map_and_realloc_map_if_not_enough_nodes_at_back(nodes_to_add);
 				for(size_type i = 1; i <= nodes_to_add; i++)
-					*(finish.node + i) = Node_Alloc::allocate(BufferSize());
+					*(impl.finish.node + i) = allocate_node();
 			}
-			iterator new_finish = finish + difference_type(n);
-			uninitialized_fill(finish, new_finish, v);
-			finish = new_finish;
-			return finish - difference_type(n);
+			iterator new_finish = impl.finish + difference_type(n);
+			grtw::uninitialized_fill(impl.finish, new_finish, v);
+			impl.finish = new_finish;
+			return impl.finish - difference_type(n);
 		}
-		else if(it == start)
+		else if(it == impl.start)
 		{
-			size_type vacancies = start.current - start.first;
+			size_type vacancies = impl.start.current - impl.start.first;
 			if(vacancies < n)
 			{
 				size_type nodes_to_add = (n - vacancies + BufferSize() - 1) / BufferSize();
 				check_map_and_realloc_map_if_not_enough_nodes_at_front(nodes_to_add);
 				for(size_type i = 1; i <= nodes_to_add; i++)
-					*(start.node - i) = Node_Alloc::allocate(BufferSize());
+					*(impl.start.node - i) = allocate_node();
 			}
-			iterator new_start = start - difference_type(n);
-			uninitialized_fill(new_start, start, v);
-			start = new_start;
-			return start;
+			iterator new_start = impl.start - difference_type(n);
+			grtw::uninitialized_fill(new_start, impl.start, v);
+			impl.start = new_start;
+			return impl.start;
 		}
 		else
 		{
@@ -469,66 +548,66 @@ namespace grtw
 	typename deque<T, Node_Alloc, Map_Alloc>::iterator
 	deque<T, Node_Alloc, Map_Alloc>::insert_aux(iterator it, size_type n, const value_type& v)
 	{
-		const difference_type elem_before = it - start;
+		const difference_type elem_before = it - impl.start;
 		value_type v_copy = v;
 		if(elem_before < difference_type(size() / 2))
 		{
-			size_type vacancies = start.current - start.first;
+			size_type vacancies = impl.start.current - impl.start.first;
 			if(vacancies < n)
 			{
 				size_type nodes_to_add = (n - vacancies + BufferSize() - 1) / BufferSize();
 				check_map_and_realloc_map_if_not_enough_nodes_at_front(nodes_to_add);
 				for(size_type i = 1; i <= nodes_to_add; ++i)
-					*(start.node - i) = Node_Alloc::allocate(BufferSize());
+					*(impl.start.node - i) = allocate_node();
 			}
-			iterator new_start = start - difference_type(n);
-			iterator old_start = start;
-			iterator pos = start + elem_before;
+			iterator new_start = impl.start - difference_type(n);
+			iterator old_start = impl.start;
+			iterator pos = impl.start + elem_before;
 			if(elem_before >= difference_type(n))
 			{
-				iterator start_n = start + difference_type(n);
-				uninitialized_copy(start, start_n, new_start);
-				copy(start_n, pos, start);
-				start = new_start;
-				fill(pos - difference_type(n), pos, v_copy);
+				iterator start_n = impl.start + difference_type(n);
+				grtw::uninitialized_move(impl.start, start_n, new_start);
+				grtw::move(start_n, pos, impl.start);
+				impl.start = new_start;
+				grtw::fill(pos - difference_type(n), pos, v_copy);
 			}
 			else
 			{
-				uninitialized_copy(start, pos, new_start);
-				uninitialized_fill(new_start + elem_before, old_start, v_copy);
-				fill(old_start, pos, v_copy);
-				start = new_start;
+				grtw::uninitialized_move(impl.start, pos, new_start);
+				grtw::uninitialized_fill(new_start + elem_before, old_start, v_copy);
+				grtw::fill(old_start, pos, v_copy);
+				impl.start = new_start;
 			}
-			return pos;
+			return impl.start + elem_before;
 		}
 		else
 		{
-			size_type vacancies = finish.last - finish.current - 1;
+			size_type vacancies = impl.finish.last - impl.finish.current - 1;
 			if(vacancies < n)
 			{
 				size_type nodes_to_add = (n - vacancies + BufferSize() - 1) / BufferSize();
 				check_map_and_realloc_map_if_not_enough_nodes_at_back(nodes_to_add);
-				for(int i = 1; i <= nodes_to_add; ++i)
-					*(finish.node + i) = Node_Alloc::allocate(BufferSize());
+				for(size_type i = 1; i <= nodes_to_add; ++i)
+					*(impl.finish.node + i) = allocate_node();
 			}
-			iterator new_finish = finish + difference_type(n);
-			iterator old_finish = finish;
+			iterator new_finish = impl.finish + difference_type(n);
+			iterator old_finish = impl.finish;
 			const difference_type elem_after = difference_type(size()) - elem_before;
-			iterator pos = finish - elem_after;
+			iterator pos = impl.finish - elem_after;
 			if(elem_after > difference_type(n))
 			{
 				iterator finish_n = old_finish - difference_type(n);
-				uninitialized_copy(finish_n, old_finish, old_finish);
-				copy_backward(pos, finish_n, old_finish);
-				finish = new_finish;
-				fill(pos, pos + difference_type(n), v_copy);
+				grtw::uninitialized_move(finish_n, old_finish, old_finish);
+				grtw::move_backward(pos, finish_n, old_finish);
+				impl.finish = new_finish;
+				grtw::fill(pos, pos + difference_type(n), v_copy);
 			}
 			else
 			{
-				uninitialized_copy(pos, old_finish, pos + difference_type(n));
-				uninitialized_fill(old_finish, pos + difference_type(n), v_copy);
-				fill(pos, old_finish, v_copy);
-				finish = new_finish;
+				grtw::uninitialized_move(pos, old_finish, pos + difference_type(n));
+				grtw::uninitialized_fill(old_finish, pos + difference_type(n), v_copy);
+				grtw::fill(pos, old_finish, v_copy);
+				impl.finish = new_finish;
 			}
 			return pos;
 		}
@@ -538,33 +617,33 @@ namespace grtw
 	void deque<T, Node_Alloc, Map_Alloc>::insert(iterator it, const value_type* vfirst, const value_type* vlast)
 	{
 		size_type n = vlast - vfirst;
-		if(it == finish)
+		if(it == impl.finish)
 		{
-			size_type vacancies = finish.last - finish.current - 1;
+			size_type vacancies = impl.finish.last - impl.finish.current - 1;
 			if(vacancies < n)
 			{
 				size_type nodes_to_add = (n - vacancies + BufferSize() - 1) / BufferSize();
 				check_map_and_realloc_map_if_not_enough_nodes_at_back(nodes_to_add);
-				for(int i = 1; i <= nodes_to_add; ++i)
-					*(finish.node + i) = Node_Alloc::allocate(BufferSize());
+				for(size_type i = 1; i <= nodes_to_add; ++i)
+					*(impl.finish.node + i) = allocate_node();
 			}
-			iterator new_finish = finish + difference_type(n);
-			uninitialized_copy(vfirst, vlast, finish);
-			finish = new_finish;
+			iterator new_finish = impl.finish + difference_type(n);
+			grtw::uninitialized_copy(vfirst, vlast, impl.finish);
+			impl.finish = new_finish;
 		}
-		else if(it == start)
+		else if(it == impl.start)
 		{
-			size_type vacancies = start.current - start.first;
+			size_type vacancies = impl.start.current - impl.start.first;
 			if(vacancies < n)
 			{
 				size_type nodes_to_add = (n - vacancies + BufferSize() - 1) / BufferSize();
 				check_map_and_realloc_map_if_not_enough_nodes_at_front(nodes_to_add);
-				for(int i = 1; i <= nodes_to_add; ++i)
-					*(start.node - i) = Node_Alloc::allocate(BufferSize());
+				for(size_type i = 1; i <= nodes_to_add; ++i)
+					*(impl.start.node - i) = allocate_node();
 			}
-			iterator new_start = start - difference_type(n);
-			uninitialized_copy(vfirst, vlast, new_start);
-			start = new_start;
+			iterator new_start = impl.start - difference_type(n);
+			grtw::uninitialized_copy(vfirst, vlast, new_start);
+			impl.start = new_start;
 		}
 		else
 			insert_aux(it, vfirst, vlast, n);
@@ -573,63 +652,63 @@ namespace grtw
 	template<class T, class Node_Alloc, class Map_Alloc>
 	void deque<T, Node_Alloc, Map_Alloc>::insert_aux(iterator it, const value_type* vfirst, const value_type* vlast, size_type n)
 	{
-		const difference_type elem_before = it - start;
+		const difference_type elem_before = it - impl.start;
 		if(elem_before < difference_type(size()/2))
 		{
-			size_type vacancies = start.current - start.first;
+			size_type vacancies = impl.start.current - impl.start.first;
 			if(vacancies < n)
 			{
 				size_type nodes_to_add = (n - vacancies + BufferSize() - 1) / BufferSize();
 				check_map_and_realloc_map_if_not_enough_nodes_at_front(nodes_to_add);
-				for(int i = 1; i <= nodes_to_add; ++i)
-					*(start.node - i) = Node_Alloc::allocate(BufferSize());
+				for(size_type i = 1; i <= nodes_to_add; ++i)
+					*(impl.start.node - i) = allocate_node();
 			}
-			iterator new_start = start - difference_type(n);
-			iterator old_start = start;
-			iterator pos = start + elem_before;
+			iterator new_start = impl.start - difference_type(n);
+			iterator old_start = impl.start;
+			iterator pos = impl.start + elem_before;
 			if(elem_before >= difference_type(n))
 			{
 				iterator start_n = old_start + difference_type(n);
-				uninitialized_copy(old_start, start_n, new_start);
-				copy(start_n, pos, old_start);
-				copy(vfirst, vlast, pos - difference_type(n));
+				grtw::uninitialized_move(old_start, start_n, new_start);
+				grtw::move(start_n, pos, old_start);
+				grtw::copy(vfirst, vlast, pos - difference_type(n));
 			}
 			else
 			{
-				uninitialized_copy(old_start, pos, new_start);
-				uninitialized_copy(vfirst, vfirst + (difference_type(n) - elem_before), new_start + elem_before);
-				copy(vfirst + (difference_type(n) - elem_before), vlast, old_start);
+				grtw::uninitialized_move(old_start, pos, new_start);
+				grtw::uninitialized_copy(vfirst, vfirst + (difference_type(n) - elem_before), new_start + elem_before);
+				grtw::copy(vfirst + (difference_type(n) - elem_before), vlast, old_start);
 			}
-			start = new_start;
+			impl.start = new_start;
 		}
 		else
 		{
-			size_type vacancies = finish.last - finish.current - 1;
+			size_type vacancies = impl.finish.last - impl.finish.current - 1;
 			if(vacancies < n)
 			{
 				size_type nodes_to_add = (n - vacancies + BufferSize() - 1) / BufferSize();
 				check_map_and_realloc_map_if_not_enough_nodes_at_back(nodes_to_add);
-				for(int i = 1; i < nodes_to_add; ++i)
-					*(finish.node + i) = Node_Alloc::allocate(BufferSize());
+				for(size_type i = 1; i <= nodes_to_add; ++i)
+					*(impl.finish.node + i) = allocate_node();
 			}
-			iterator new_finish = finish + difference_type(n);
-			iterator old_finish = finish;
+			iterator new_finish = impl.finish + difference_type(n);
+			iterator old_finish = impl.finish;
 			const difference_type elem_after = difference_type(size()) - elem_before;
-			iterator pos = finish - elem_after;
+			iterator pos = impl.finish - elem_after;
 			if(elem_after > difference_type(n))
 			{
 				iterator finish_n = old_finish - difference_type(n);
-				uninitialized_copy(finish_n, old_finish, old_finish);
-				copy_backward(pos, finish_n, old_finish);
-				copy(vfirst, vlast, pos);
+				grtw::uninitialized_move(finish_n, old_finish, old_finish);
+				grtw::move_backward(pos, finish_n, old_finish);
+				grtw::copy(vfirst, vlast, pos);
 			}
 			else
 			{
-				uninitialized_copy(pos, old_finish, pos + difference_type(n));
-				copy(vfirst, vfirst + elem_after, pos);
-				uninitialized_copy(vfirst + elem_after, vlast, pos + elem_after);
+				grtw::uninitialized_move(pos, old_finish, pos + difference_type(n));
+				grtw::copy(vfirst, vfirst + elem_after, pos);
+				grtw::uninitialized_copy(vfirst + elem_after, vlast, pos + elem_after);
 			}
-			finish = new_finish;
+			impl.finish = new_finish;
 		}
 	}
 
@@ -637,33 +716,33 @@ namespace grtw
 	void deque<T, Node_Alloc, Map_Alloc>::insert(iterator it, const_iterator vfirst, const_iterator vlast)
 	{
 		size_type n = vlast - vfirst;
-		if(it == finish)
+		if(it == impl.finish)
 		{
-			size_type vacancies = finish.last - finish.current - 1;
+			size_type vacancies = impl.finish.last - impl.finish.current - 1;
 			if(vacancies < n)
 			{
 				size_type nodes_to_add = (n - vacancies + BufferSize() - 1) / BufferSize();
 				check_map_and_realloc_map_if_not_enough_nodes_at_back(nodes_to_add);
-				for(int i = 1; i <= nodes_to_add; ++i)
-					*(finish.node + i) = Node_Alloc::allocate(BufferSize());
+				for(size_type i = 1; i <= nodes_to_add; ++i)
+					*(impl.finish.node + i) = allocate_node();
 			}
-			iterator new_finish = finish + difference_type(n);
-			uninitialized_copy(vfirst, vlast, finish);
-			finish = new_finish;
+			iterator new_finish = impl.finish + difference_type(n);
+			grtw::uninitialized_copy(vfirst, vlast, impl.finish);
+			impl.finish = new_finish;
 		}
-		else if(it == start)
+		else if(it == impl.start)
 		{
-			size_type vacancies = start.current - start.first;
+			size_type vacancies = impl.start.current - impl.start.first;
 			if(vacancies < n)
 			{
 				size_type nodes_to_add = (n - vacancies + BufferSize() - 1) / BufferSize();
 				check_map_and_realloc_map_if_not_enough_nodes_at_front(nodes_to_add);
-				for(int i = 1; i <= nodes_to_add; ++i)
-					*(start.node - i) = Node_Alloc::allocate(BufferSize());
+				for(size_type i = 1; i <= nodes_to_add; ++i)
+					*(impl.start.node - i) = allocate_node();
 			}
-			iterator new_start = start - difference_type(n);
-			uninitialized_copy(vfirst, vlast, new_start);
-			start = new_start;
+			iterator new_start = impl.start - difference_type(n);
+			grtw::uninitialized_copy(vfirst, vlast, new_start);
+			impl.start = new_start;
 		}
 		else
 			insert_aux(it, vfirst, vlast, n);
@@ -672,97 +751,129 @@ namespace grtw
 	template<class T, class Node_Alloc, class Map_Alloc>
 	void deque<T, Node_Alloc, Map_Alloc>::insert_aux(iterator it, const_iterator vfirst, const_iterator vlast, size_type n)
 	{
-		const difference_type elem_before = it - start;
+		const difference_type elem_before = it - impl.start;
 		if(elem_before < difference_type(size()/2))
 		{
-			size_type vacancies = start.current - start.first;
+			size_type vacancies = impl.start.current - impl.start.first;
 			if(vacancies < n)
 			{
 				size_type nodes_to_add = (n - vacancies + BufferSize() - 1) / BufferSize();
 				check_map_and_realloc_map_if_not_enough_nodes_at_front(nodes_to_add);
-				for(int i = 1; i <= nodes_to_add; ++i)
-					*(start.node - i) = Node_Alloc::allocate(BufferSize());
+				for(size_type i = 1; i <= nodes_to_add; ++i)
+					*(impl.start.node - i) = allocate_node();
 			}
-			iterator new_start = start - difference_type(n);
-			iterator old_start = start;
-			iterator pos = start + elem_before;
+			iterator new_start = impl.start - difference_type(n);
+			iterator old_start = impl.start;
+			iterator pos = impl.start + elem_before;
 			if(elem_before >= difference_type(n))
 			{
 				iterator start_n = old_start + difference_type(n);
-				uninitialized_copy(old_start, start_n, new_start);
-				copy(start_n, pos, old_start);
-				copy(vfirst, vlast, pos - difference_type(n));
+				grtw::uninitialized_move(old_start, start_n, new_start);
+				grtw::move(start_n, pos, old_start);
+				grtw::copy(vfirst, vlast, pos - difference_type(n));
 			}
 			else
 			{
-				uninitialized_copy(old_start, pos, new_start);
-				uninitialized_copy(vfirst, vfirst + (difference_type(n) - elem_before), new_start + elem_before);
-				copy(vfirst + (difference_type(n) - elem_before), vlast, old_start);
+				grtw::uninitialized_move(old_start, pos, new_start);
+				grtw::uninitialized_copy(vfirst, vfirst + (difference_type(n) - elem_before), new_start + elem_before);
+				grtw::copy(vfirst + (difference_type(n) - elem_before), vlast, old_start);
 			}
-			start = new_start;
+			impl.start = new_start;
 		}
 		else
 		{
-			size_type vacancies = finish.last - finish.current - 1;
+			size_type vacancies = impl.finish.last - impl.finish.current - 1;
 			if(vacancies < n)
 			{
 				size_type nodes_to_add = (n - vacancies + BufferSize() - 1) / BufferSize();
 				check_map_and_realloc_map_if_not_enough_nodes_at_back(nodes_to_add);
-				for(int i = 1; i < nodes_to_add; ++i)
-					*(finish.node + i) = Node_Alloc::allocate(BufferSize());
+				for(size_type i = 1; i <= nodes_to_add; ++i)
+					*(impl.finish.node + i) = allocate_node();
 			}
-			iterator new_finish = finish + difference_type(n);
-			iterator old_finish = finish;
+			iterator new_finish = impl.finish + difference_type(n);
+			iterator old_finish = impl.finish;
 			const difference_type elem_after = difference_type(size()) - elem_before;
-			iterator pos = finish - elem_after;
+			iterator pos = impl.finish - elem_after;
 			if(elem_after > difference_type(n))
 			{
 				iterator finish_n = old_finish - difference_type(n);
-				uninitialized_copy(finish_n, old_finish, old_finish);
-				copy_backward(pos, finish_n, old_finish);
-				copy(vfirst, vlast, pos);
+				grtw::uninitialized_move(finish_n, old_finish, old_finish);
+				grtw::move_backward(pos, finish_n, old_finish);
+				grtw::copy(vfirst, vlast, pos);
 			}
 			else
 			{
-				uninitialized_copy(pos, old_finish, pos + difference_type(n));
-				copy(vfirst, vfirst + elem_after, pos);
-				uninitialized_copy(vfirst + elem_after, vlast, pos + elem_after);
+				grtw::uninitialized_move(pos, old_finish, pos + difference_type(n));
+				grtw::copy(vfirst, vfirst + elem_after, pos);
+				grtw::uninitialized_copy(vfirst + elem_after, vlast, pos + elem_after);
 			}
-			finish = new_finish;
+			impl.finish = new_finish;
 		}
 	}
 
 	template<class T, class Node_Alloc, class Map_Alloc>
 	void deque<T, Node_Alloc, Map_Alloc>::pop_back()
 	{
-		if(finish.current != finish.first)
+		if(impl.finish.current != impl.finish.first)
 		{
-			--finish;
-			destroy(finish.current);
+			--impl.finish;
+			grtw::destroy(impl.finish.current);
 		}
 		else
 		{
-			Node_Alloc::deallocate(finish.first, BufferSize());
-			finish.set_node(finish.node - 1);
-			finish.current = finish.last - 1;
-			destroy(finish.current);
+			deallocate_node(impl.finish.first);
+			impl.finish.set_node(impl.finish.node - 1);
+			impl.finish.current = impl.finish.last - 1;
+			grtw::destroy(impl.finish.current);
 		}
 	}
 
 	template<class T, class Node_Alloc, class Map_Alloc>
 	void deque<T, Node_Alloc, Map_Alloc>::pop_front()
 	{
-		if(start.current != start.last - 1)
+		if(impl.start.current != impl.start.last - 1)
 		{
-			destroy(start.current);
-			++start;
+			grtw::destroy(impl.start.current);
+			++impl.start;
 		}
 		else
 		{
-			destroy(start.current);
-			Node_Alloc::deallocate(start.first, BufferSize())
-			start.set_node(start.node + 1);
-			start.current = start.first;
+			grtw::destroy(impl.start.current);
+			deallocate_node(impl.start.first);
+			impl.start.set_node(impl.start.node + 1);
+			impl.start.current = impl.start.first;
+		}
+	}
+
+	//memmove [first, last) to dest one run of contiguous slots at a time, for relocatable
+	//elements shifting down within the deque
+	template<class T, class Node_Alloc, class Map_Alloc>
+	void deque<T, Node_Alloc, Map_Alloc>::relocate(iterator first, iterator last, iterator dest)
+	{
+		difference_type n = last - first;
+		while(n > 0)
+		{
+			difference_type len = grtw::min(n, grtw::min(first.last - first.current, dest.last - dest.current));
+			memmove((void*)dest.current, (const void*)first.current, sizeof(value_type) * len);
+			first += len;
+			dest += len;
+			n -= len;
+		}
+	}
+
+	template<class T, class Node_Alloc, class Map_Alloc>
+	void deque<T, Node_Alloc, Map_Alloc>::relocate_backward(iterator first, iterator last, iterator dest_last)
+	{
+		difference_type n = last - first;
+		while(n > 0)
+		{
+			iterator src = last - 1;
+			iterator dst = dest_last - 1;
+			difference_type len = grtw::min(n, grtw::min(src.current - src.first, dst.current - dst.first) + 1);
+			memmove((void*)(dst.current + 1 - len), (const void*)(src.current + 1 - len), sizeof(value_type) * len);
+			last -= len;
+			dest_last -= len;
+			n -= len;
 		}
 	}
 
@@ -770,81 +881,128 @@ namespace grtw
 	typename deque<T, Node_Alloc, Map_Alloc>::iterator
 	deque<T, Node_Alloc, Map_Alloc>::erase(iterator it)
 	{
-		difference_type index = it - start;
+		return erase_aux(it, relocatable());
+	}
+
+	template<class T, class Node_Alloc, class Map_Alloc>
+	typename deque<T, Node_Alloc, Map_Alloc>::iterator
+	deque<T, Node_Alloc, Map_Alloc>::erase_aux(iterator it, true_type)
+	{
+		return erase(it, it + 1);
+	}
+
+	template<class T, class Node_Alloc, class Map_Alloc>
+	typename deque<T, Node_Alloc, Map_Alloc>::iterator
+	deque<T, Node_Alloc, Map_Alloc>::erase_aux(iterator it, false_type)
+	{
+		difference_type index = it - impl.start;
 		iterator next = it + 1;
 		if(size_type(index) < size()/2)
 		{
-			copy_backward(start, pos, next);
+			grtw::move_backward(impl.start, it, next);
 			pop_front();
 		}
 		else
 		{
-			copy(next, finish, pos);
+			grtw::move(next, impl.finish, it);
 			pop_back();
 		}
-		return start + index;
+		return impl.start + index;
 	}
 
 	template<class T, class Node_Alloc, class Map_Alloc>
 	typename deque<T, Node_Alloc, Map_Alloc>::iterator
 	deque<T, Node_Alloc, Map_Alloc>::erase(iterator vfirst, iterator vlast)
 	{
-		if(vfirst == start && vlast == finish)
+		if(vfirst == impl.start && vlast == impl.finish)
 		{
 			clear();
-			return finish;
+			return impl.finish;
 		}
 		else
+			return erase_aux(vfirst, vlast, relocatable());
+	}
+
+	//the shorter side is shifted over the erased range
+	template<class T, class Node_Alloc, class Map_Alloc>
+	typename deque<T, Node_Alloc, Map_Alloc>::iterator
+	deque<T, Node_Alloc, Map_Alloc>::erase_aux(iterator vfirst, iterator vlast, true_type)
+	{
+		difference_type n = vlast - vfirst;
+		difference_type elem_before = vfirst - impl.start;
+		grtw::destroy(vfirst, vlast);
+		if(elem_before < (difference_type(size()) - n) / 2)
 		{
-			difference_type n = vlast - vfirst;
-			difference_type elem_before = vfirst - start;
-			if(elem_before < difference_type(size() - n/2))
-			{
-				copy_backward(start, vfirst, vlast)
-				iterator new_start = start + n;
-				destroy(start, new_start);
-				destroy_nodes(start.node, new_start.node);
-				start = new_start;
-			}
-			else
-			{
-				copy(vlast, finish, vfirst);
-				iterator new_finish = finish - n;
-				destroy(new_finish, finish);
-				destroy_nodes(new_finish.node + 1, finish.node + 1);
-				finish = new_finish;
-			}
-			return start + elem_before;
+			relocate_backward(impl.start, vfirst, vlast);
+			iterator new_start = impl.start + n;
+			destroy_nodes(impl.start.node, new_start.node);
+			impl.start = new_start;
+		}
+		else
+		{
+			relocate(vlast, impl.finish, vfirst);
+			iterator new_finish = impl.finish - n;
+			destroy_nodes(new_finish.node + 1, impl.finish.node + 1);
+			impl.finish = new_finish;
+		}
+		return impl.start + elem_before;
+	}
+
+	template<class T, class Node_Alloc, class Map_Alloc>
+	typename deque<T, Node_Alloc, Map_Alloc>::iterator
+	deque<T, Node_Alloc, Map_Alloc>::erase_aux(iterator vfirst, iterator vlast, false_type)
+	{
+		//an empty range would move every element on one side onto itself
+		if(vfirst == vlast)
+			return vfirst;
+		difference_type n = vlast - vfirst;
+		difference_type elem_before = vfirst - impl.start;
+		if(elem_before < (difference_type(size()) - n) / 2)
+		{
+			grtw::move_backward(impl.start, vfirst, vlast);
+			iterator new_start = impl.start + n;
+			grtw::destroy(impl.start, new_start);
+			destroy_nodes(impl.start.node, new_start.node);
+			impl.start = new_start;
+		}
+		else
+		{
+			grtw::move(vlast, impl.finish, vfirst);
+			iterator new_finish = impl.finish - n;
+			grtw::destroy(new_finish, impl.finish);
+			destroy_nodes(new_finish.node + 1, impl.finish.node + 1);
+			impl.finish = new_finish;
 		}
+		return impl.start + elem_before;
 	}
 
 	template<class T, class Node_Alloc, class Map_Alloc>
 	void deque<T, Node_Alloc, Map_Alloc>::clear()
 	{
-		for(value_type** node = start.node + 1; node < finish.node; ++node)
+		for(value_type** node = impl.start.node + 1; node < impl.finish.node; ++node)
 		{
-			destroy(*node, *node + BufferSize())
-			Node_Alloc::deallocate(*node, BufferSize());
+			grtw::destroy(*node, *node + BufferSize());
+			deallocate_node(*node);
 		}
 
-		if(start.node != finish.node)
+		if(impl.start.node != impl.finish.node)
 		{
-			destroy(start.current, start.last);
-			destroy(finish.first, finish.current);
-			Node_Alloc::deallocate(finish.first, BufferSize());
+			grtw::destroy(impl.start.current, impl.start.last);
+			grtw::destroy(impl.finish.first, impl.finish.current);
+			deallocate_node(impl.finish.first);
 		}
 		else
-			destroy(start.current, finish.current);
-		finish = start;
+			grtw::destroy(impl.start.current, impl.finish.current);
+		impl.finish = impl.start;
 	}
 
 	template<class T, class Node_Alloc, class Map_Alloc>
 	void deque<T, Node_Alloc, Map_Alloc>::resize(size_type new_size)
 	{
 		if(new_size < size())
-			erase(start + new_size, finish);
+			erase(impl.start + new_size, impl.finish);
 		else
-			insert(finish, new_size - size(), value_type());
+			insert(impl.finish, new_size - size(), value_type());
 	}
 }
 
@@ -0,0 +1,113 @@
+#ifndef GRTW_STL_FLAT_HASHMAP_H
+#define GRTW_STL_FLAT_HASHMAP_H
+
+#include"stl_function.h"
+#include"stl_hash_function.h"
+#include"stl_flat_hashtable.h"
+#include"stl_pair.h"
+#include"stl_utility.h"
+
+namespace grtw
+{
+	//flat_hash_map: unordered map on flat_hashtable; elements live in the slot array, so
+	//insertions that grow the table move them and invalidate references
+	template<class Key, class Value, class HashFcn = hash<Key>, class EqualKey = equal_to<Key>, class Alloc = default_alloc>
+	class flat_hash_map
+	{
+	private:
+		using value_type = pair<const Key, Value>;
+		using repo_type = flat_hashtable<value_type, Key, HashFcn, select1st<value_type>, EqualKey, Alloc>;
+
+	public:
+		using key_type = Key;
+		using mapped_type = Value;
+		using hasher = typename repo_type::hasher;
+		using key_equal = typename repo_type::key_equal;
+		using pointer = typename repo_type::pointer;
+		using const_pointer = typename repo_type::const_pointer;
+		using reference = typename repo_type::reference;
+		using const_reference = typename repo_type::const_reference;
+		using iterator = typename repo_type::iterator;
+		using const_iterator = typename repo_type::const_iterator;
+		using size_type = typename repo_type::size_type;
+		using difference_type = typename repo_type::difference_type;
+
+	private:
+		repo_type repository;
+
+	public:
+		flat_hash_map() : repository() {}
+		explicit flat_hash_map(size_type n) : repository(n) {}
+		flat_hash_map(size_type n, const hasher& hf) : repository(n, hf) {}
+		flat_hash_map(size_type n, const hasher& hf, const key_equal& eql) : repository(n, hf, eql) {}
+		flat_hash_map(const value_type* vfirst, const value_type* vlast) : repository(vlast - vfirst) { insert(vfirst, vlast); }
+		flat_hash_map(const flat_hash_map& other) : repository(other.repository) {}
+		flat_hash_map(flat_hash_map&& other) : repository(grtw::move(other.repository)) {}
+
+		flat_hash_map& operator=(const flat_hash_map& other)
+		{
+			repository = other.repository;
+			return *this;
+		}
+
+		flat_hash_map& operator=(flat_hash_map&& other)
+		{
+			repository = grtw::move(other.repository);
+			return *this;
+		}
+
+		void swap(flat_hash_map& other) noexcept { repository.swap(other.repository); }
+
+		hasher hash_funct() const { return repository.hash_funct(); }
+		key_equal key_eq() const { return repository.key_eq(); }
+
+		iterator begin() { return repository.begin(); }
+		const_iterator begin() const { return repository.begin(); }
+		iterator end() { return repository.end(); }
+		const_iterator end() const { return repository.end(); }
+		bool empty() const { return repository.empty(); }
+		size_type size() const { return repository.size(); }
+		size_type bucket_count() const { return repository.bucket_count(); }
+
+		void reserve(size_type n) { repository.reserve(n); }
+
+		Value& operator[](const Key& k) { return try_emplace(k).first->second; }
+		Value& operator[](Key&& k) { return try_emplace(grtw::move(k)).first->second; }
+
+		pair<iterator, bool> insert(const value_type& x) { return repository.insert_unique(x); }
+		pair<iterator, bool> insert(value_type&& x) { return repository.insert_unique(grtw::move(x)); }
+
+		void insert(const value_type* vfirst, const value_type* vlast)
+		{
+			for(; vfirst != vlast; ++vfirst)
+				repository.insert_unique(*vfirst);
+		}
+
+		template<class... Args>
+		pair<iterator, bool> emplace(Args&&... args) { return repository.emplace_unique(grtw::forward<Args>(args)...); }
+
+		//the mapped value is only built when k is not present yet, args are left alone otherwise
+		template<class... Args>
+		pair<iterator, bool> try_emplace(const Key& k, Args&&... args)
+		{
+			return repository.emplace_unique_key(k, pair_emplace_t(), k, grtw::forward<Args>(args)...);
+		}
+
+		template<class... Args>
+		pair<iterator, bool> try_emplace(Key&& k, Args&&... args)
+		{
+			return repository.emplace_unique_key(k, pair_emplace_t(), grtw::move(k), grtw::forward<Args>(args)...);
+		}
+
+		void erase(const_iterator it) { repository.erase(it); }
+		size_type erase(const Key& k) { return repository.erase(k); }
+
+		void clear() { repository.clear(); }
+
+		iterator find(const Key& k) { return repository.find(k); }
+		const_iterator find(const Key& k) const { return repository.find(k); }
+		size_type count(const Key& k) const { return repository.count_key(k); }
+	};
+}
+
+#endif
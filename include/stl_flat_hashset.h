@@ -0,0 +1,104 @@
+#ifndef GRTW_STL_FLAT_HASHSET_H
+#define GRTW_STL_FLAT_HASHSET_H
+
+#include"stl_function.h"
+#include"stl_hash_function.h"
+#include"stl_flat_hashtable.h"
+#include"stl_pair.h"
+#include"stl_utility.h"
+
+namespace grtw
+{
+	template<class Key, class HashFcn = hash<Key>, class EqualKey = equal_to<Key>, class Alloc = default_alloc>
+	class flat_hash_set
+	{
+	private:
+		using value_type = Key;
+		using repo_type = flat_hashtable<Key, Key, HashFcn, identity<Key>, EqualKey, Alloc>;
+
+	public:
+		using key_type = Key;
+		using hasher = typename repo_type::hasher;
+		using key_equal = typename repo_type::key_equal;
+		using pointer = typename repo_type::const_pointer;
+		using const_pointer = typename repo_type::const_pointer;
+		using reference = typename repo_type::const_reference;
+		using const_reference = typename repo_type::const_reference;
+		using iterator = typename repo_type::const_iterator;
+		using const_iterator = typename repo_type::const_iterator;
+		using size_type = typename repo_type::size_type;
+		using difference_type = typename repo_type::difference_type;
+
+	private:
+		repo_type repository;
+
+	public:
+		flat_hash_set() : repository() {}
+		explicit flat_hash_set(size_type n) : repository(n) {}
+		flat_hash_set(size_type n, const hasher& hf) : repository(n, hf) {}
+		flat_hash_set(size_type n, const hasher& hf, const key_equal& eql) : repository(n, hf, eql) {}
+		flat_hash_set(const value_type* vfirst, const value_type* vlast) : repository(vlast - vfirst) { insert(vfirst, vlast); }
+		flat_hash_set(const flat_hash_set& other) : repository(other.repository) {}
+		flat_hash_set(flat_hash_set&& other) : repository(grtw::move(other.repository)) {}
+
+		flat_hash_set& operator=(const flat_hash_set& other)
+		{
+			repository = other.repository;
+			return *this;
+		}
+
+		flat_hash_set& operator=(flat_hash_set&& other)
+		{
+			repository = grtw::move(other.repository);
+			return *this;
+		}
+
+		void swap(flat_hash_set& other) noexcept { repository.swap(other.repository); }
+
+		hasher hash_funct() const { return repository.hash_funct(); }
+		key_equal key_eq() const { return repository.key_eq(); }
+
+		iterator begin() const { return repository.begin(); }
+		iterator end() const { return repository.end(); }
+		bool empty() const { return repository.empty(); }
+		size_type size() const { return repository.size(); }
+		size_type bucket_count() const { return repository.bucket_count(); }
+
+		void reserve(size_type n) { repository.reserve(n); }
+
+		pair<iterator, bool> insert(const value_type& x)
+		{
+			pair<typename repo_type::iterator, bool> p = repository.insert_unique(x);
+			return pair<iterator, bool>(p.first, p.second);
+		}
+
+		pair<iterator, bool> insert(value_type&& x)
+		{
+			pair<typename repo_type::iterator, bool> p = repository.insert_unique(grtw::move(x));
+			return pair<iterator, bool>(p.first, p.second);
+		}
+
+		void insert(const value_type* vfirst, const value_type* vlast)
+		{
+			for(; vfirst != vlast; ++vfirst)
+				repository.insert_unique(*vfirst);
+		}
+
+		template<class... Args>
+		pair<iterator, bool> emplace(Args&&... args)
+		{
+			pair<typename repo_type::iterator, bool> p = repository.emplace_unique(grtw::forward<Args>(args)...);
+			return pair<iterator, bool>(p.first, p.second);
+		}
+
+		void erase(iterator it) { repository.erase(it); }
+		size_type erase(const Key& k) { return repository.erase(k); }
+
+		void clear() { repository.clear(); }
+
+		iterator find(const Key& k) const { return repository.find(k); }
+		size_type count(const Key& k) const { return repository.count_key(k); }
+	};
+}
+
+#endif
@@ -0,0 +1,480 @@
+#ifndef GRTW_STL_FLAT_HASHTABLE_H
+#define GRTW_STL_FLAT_HASHTABLE_H
+
+#include<cstddef>
+#include<cstring>
+#ifdef __SSE2__
+#include<emmintrin.h>
+#endif
+#include"stl_iterator_base.h"
+#include"stl_allocator.h"
+#include"stl_construct.h"
+#include"stl_uninitialized.h"
+#include"stl_algorithms.h"
+#include"stl_pair.h"
+#include"stl_utility.h"
+
+namespace grtw
+{
+	//one control byte per slot: a full slot holds the low 7 bits of its hash (0..127), the
+	//others have the high bit set; the sentinel after the last slot stops iteration
+	enum flat_ctrl : signed char
+	{
+		flat_empty = -128,
+		flat_deleted = -2,
+		flat_sentinel = -1
+	};
+
+	//flat_group: 16 control bytes matched at once, bit i of a result stands for byte i
+	struct flat_group
+	{
+		static const size_t width = 16;
+
+#ifdef __SSE2__
+		__m128i ctrl;
+
+		explicit flat_group(const signed char* p) : ctrl(_mm_load_si128(reinterpret_cast<const __m128i*>(p))) {}
+
+		unsigned match(signed char h) const { return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h), ctrl)); }
+		unsigned match_empty() const { return match(flat_empty); }
+		//empty or deleted: every byte below the sentinel
+		unsigned match_free() const { return _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(flat_sentinel), ctrl)); }
+#else
+		const signed char* ctrl;
+
+		explicit flat_group(const signed char* p) : ctrl(p) {}
+
+		unsigned match(signed char h) const
+		{
+			unsigned res = 0;
+			for(size_t i = 0; i < width; ++i)
+				if(ctrl[i] == h)
+					res |= 1u << i;
+			return res;
+		}
+
+		unsigned match_empty() const { return match(flat_empty); }
+
+		unsigned match_free() const
+		{
+			unsigned res = 0;
+			for(size_t i = 0; i < width; ++i)
+				if(ctrl[i] < flat_sentinel)
+					res |= 1u << i;
+			return res;
+		}
+#endif
+	};
+
+	template<class Value, class Reference, class Pointer>
+	struct flat_hashtable_iterator
+	{
+		using iterator_category = forward_iterator_tag;
+		using value_type = Value;
+		using difference_type = ptrdiff_t;
+		using reference = Reference;
+		using pointer = Pointer;
+
+		using Self = flat_hashtable_iterator<Value, Reference, Pointer>;
+		using iterator = flat_hashtable_iterator<Value, Value&, Value*>;
+
+		const signed char* ctrl;
+		Value* slot;
+
+		flat_hashtable_iterator() : ctrl(nullptr), slot(nullptr) {}
+		flat_hashtable_iterator(const signed char* c, Value* s) : ctrl(c), slot(s) {}
+		flat_hashtable_iterator(const iterator& x) : ctrl(x.ctrl), slot(x.slot) {}
+
+		reference operator*() const { return *slot; }
+		pointer operator->() const { return slot; }
+
+		//moves to the next full slot or the sentinel
+		void skip_free()
+		{
+			while(*ctrl < flat_sentinel)
+			{
+				++ctrl;
+				++slot;
+			}
+		}
+
+		Self& operator++()
+		{
+			++ctrl;
+			++slot;
+			skip_free();
+			return *this;
+		}
+
+		Self operator++(int)
+		{
+			Self tmp = *this;
+			++*this;
+			return tmp;
+		}
+
+		bool operator==(const Self& x) const { return ctrl == x.ctrl; }
+		bool operator!=(const Self& x) const { return ctrl != x.ctrl; }
+	};
+
+	//flat_hashtable: open addressing with the values stored in one slot array (Swiss table
+	//layout). A lookup hashes once, then scans the control bytes of a 16-slot group for the 7
+	//bit tag and only compares keys whose tag matches; a group with an empty byte ends the
+	//probe. Groups are probed quadratically, the table grows by doubling at 7/8 load, and
+	//erase leaves a tombstone only when a probe may have passed the slot
+	template<class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc = default_alloc>
+	class flat_hashtable
+	{
+	public:
+		using key_type = Key;
+		using value_type = Value;
+		using hasher = HashFcn;
+		using key_equal = EqualKey;
+		using size_type = size_t;
+		using difference_type = ptrdiff_t;
+		using pointer = value_type*;
+		using const_pointer = const value_type*;
+		using reference = value_type&;
+		using const_reference = const value_type&;
+
+		using iterator = flat_hashtable_iterator<Value, Value&, Value*>;
+		using const_iterator = flat_hashtable_iterator<Value, const Value&, const Value*>;
+
+	private:
+		using ctrl_alloc = allocator<signed char, Alloc, flat_group::width>;
+		using slot_alloc = allocator<Value, Alloc>;
+
+		static const size_type width = flat_group::width;
+		static const size_type npos = size_type(-1);
+
+		signed char* ctrl;
+		Value* slots;
+		size_type capacity;
+		size_type count;
+		size_type growth_left;
+		hasher hash;
+		key_equal equals;
+		ExtractKey get_key;
+
+		//ctrl of a table without slots: a lone sentinel, so begin() == end()
+		static signed char* empty_ctrl()
+		{
+			static signed char sentinel = flat_sentinel;
+			return &sentinel;
+		}
+
+		static size_type max_load(size_type cap) { return cap - cap / 8; }
+
+		//the user hash may be the identity, so it is mixed before its bits are split into the
+		//group index and the tag
+		size_t hash_of(const Key& k) const
+		{
+			unsigned __int128 m = (unsigned __int128)hash(k) * 0x9E3779B97F4A7C15ull;
+			return size_t(m) ^ size_t(m >> 64);
+		}
+
+		static signed char tag(size_t h) { return static_cast<signed char>(h & 0x7F); }
+
+		size_type find_index(const Key& k, size_t h) const
+		{
+			if(capacity == 0)
+				return npos;
+			size_type mask = capacity / width - 1;
+			size_type g = (h >> 7) & mask;
+			for(size_type step = 1; ; ++step)
+			{
+				flat_group group(ctrl + g * width);
+				for(unsigned m = group.match(tag(h)); m != 0; m &= m - 1)
+				{
+					size_type i = g * width + __builtin_ctz(m);
+					if(equals(get_key(slots[i]), k))
+						return i;
+				}
+				if(group.match_empty() != 0)
+					return npos;
+				g = (g + step) & mask;
+			}
+		}
+
+		//first empty or deleted slot on the probe sequence of h
+		size_type find_free(size_t h) const
+		{
+			size_type mask = capacity / width - 1;
+			size_type g = (h >> 7) & mask;
+			for(size_type step = 1; ; ++step)
+			{
+				unsigned m = flat_group(ctrl + g * width).match_free();
+				if(m != 0)
+					return g * width + __builtin_ctz(m);
+				g = (g + step) & mask;
+			}
+		}
+
+		//finds a slot for a new element of hash h, growing first when the table is full; the
+		//caller constructs the value in it and then calls commit_insert, so a constructor that
+		//throws leaves the slot free
+		size_type prepare_insert(size_t h)
+		{
+			size_type i = capacity == 0 ? 0 : find_free(h);
+			if(growth_left == 0 && (capacity == 0 || ctrl[i] != flat_deleted))
+			{
+				//mostly tombstones: rehash in place of growing
+				if(capacity != 0 && count <= max_load(capacity) / 2)
+					resize(capacity);
+				else
+					resize(capacity == 0 ? width : capacity * 2);
+				i = find_free(h);
+			}
+			return i;
+		}
+
+		void commit_insert(size_type i, size_t h)
+		{
+			if(ctrl[i] == flat_empty)
+				--growth_left;
+			ctrl[i] = tag(h);
+			++count;
+		}
+
+		//frees the slot array unless released, for when the control bytes fail to allocate
+		struct slot_guard
+		{
+			Value* p;
+			size_type n;
+
+			~slot_guard()
+			{
+				if(p != nullptr)
+					slot_alloc::deallocate(p, n);
+			}
+		};
+
+		//the members switch to the new table only once both arrays are allocated, so a
+		//bad_alloc leaves the current table as it was
+		void allocate_table(size_type cap)
+		{
+			slot_guard guard = { slot_alloc::allocate(cap), cap };
+			signed char* new_ctrl = ctrl_alloc::allocate(cap + 1);
+			memset(new_ctrl, flat_empty, cap);
+			new_ctrl[cap] = flat_sentinel;
+			capacity = cap;
+			ctrl = new_ctrl;
+			slots = guard.p;
+			guard.p = nullptr;
+			growth_left = max_load(cap) - count;
+		}
+
+		void deallocate_table()
+		{
+			if(capacity != 0)
+			{
+				ctrl_alloc::deallocate(ctrl, capacity + 1);
+				slot_alloc::deallocate(slots, capacity);
+			}
+		}
+
+		//moves every element into a fresh table of cap slots
+		void resize(size_type cap)
+		{
+			signed char* old_ctrl = ctrl;
+			Value* old_slots = slots;
+			size_type old_capacity = capacity;
+			allocate_table(cap);
+			for(size_type i = 0; i < old_capacity; ++i)
+			{
+				if(old_ctrl[i] >= 0)
+				{
+					size_t h = hash_of(get_key(old_slots[i]));
+					size_type j = find_free(h);
+					ctrl[j] = tag(h);
+					grtw::uninitialized_relocate(old_slots + i, old_slots + i + 1, slots + j);
+				}
+			}
+			if(old_capacity != 0)
+			{
+				ctrl_alloc::deallocate(old_ctrl, old_capacity + 1);
+				slot_alloc::deallocate(old_slots, old_capacity);
+			}
+		}
+
+		void destroy_all()
+		{
+			for(size_type i = 0; i < capacity; ++i)
+				if(ctrl[i] >= 0)
+					grtw::destroy(slots + i);
+		}
+
+		void erase_index(size_type i)
+		{
+			grtw::destroy(slots + i);
+			--count;
+			//a group that still has an empty byte never ended a probe, nothing passed it
+			if(flat_group(ctrl + (i & ~(width - 1))).match_empty() != 0)
+			{
+				ctrl[i] = flat_empty;
+				++growth_left;
+			}
+			else
+				ctrl[i] = flat_deleted;
+		}
+
+		iterator make_iterator(size_type i) { return i == npos ? end() : iterator(ctrl + i, slots + i); }
+		const_iterator make_iterator(size_type i) const { return i == npos ? end() : const_iterator(ctrl + i, slots + i); }
+
+		static size_type capacity_for(size_type n)
+		{
+			size_type cap = width;
+			while(max_load(cap) < n)
+				cap *= 2;
+			return cap;
+		}
+
+	public:
+		explicit flat_hashtable(size_type n = 0, const hasher& hf = hasher(), const key_equal& eql = key_equal())
+			: ctrl(empty_ctrl()), slots(nullptr), capacity(0), count(0), growth_left(0), hash(hf), equals(eql), get_key()
+		{
+			reserve(n);
+		}
+
+		flat_hashtable(const flat_hashtable& other)
+			: ctrl(empty_ctrl()), slots(nullptr), capacity(0), count(0), growth_left(0), hash(other.hash), equals(other.equals), get_key(other.get_key)
+		{
+			//filled on the side, so a throwing copy is cleaned up by tmp's destructor
+			flat_hashtable tmp(other.count, other.hash, other.equals);
+			for(const_iterator it = other.begin(); it != other.end(); ++it)
+			{
+				size_t h = tmp.hash_of(get_key(*it));
+				size_type i = tmp.prepare_insert(h);
+				grtw::construct(tmp.slots + i, *it);
+				tmp.commit_insert(i, h);
+			}
+			swap(tmp);
+		}
+
+		flat_hashtable(flat_hashtable&& other) noexcept
+			: ctrl(other.ctrl), slots(other.slots), capacity(other.capacity), count(other.count), growth_left(other.growth_left),
+			hash(other.hash), equals(other.equals), get_key(other.get_key)
+		{
+			other.ctrl = empty_ctrl();
+			other.slots = nullptr;
+			other.capacity = other.count = other.growth_left = 0;
+		}
+
+		flat_hashtable& operator=(const flat_hashtable& other)
+		{
+			if(this != &other)
+			{
+				flat_hashtable tmp(other);
+				swap(tmp);
+			}
+			return *this;
+		}
+
+		flat_hashtable& operator=(flat_hashtable&& other) noexcept
+		{
+			flat_hashtable tmp(grtw::move(other));
+			swap(tmp);
+			return *this;
+		}
+
+		~flat_hashtable()
+		{
+			destroy_all();
+			deallocate_table();
+		}
+
+		void swap(flat_hashtable& other) noexcept
+		{
+			grtw::swap(ctrl, other.ctrl);
+			grtw::swap(slots, other.slots);
+			grtw::swap(capacity, other.capacity);
+			grtw::swap(count, other.count);
+			grtw::swap(growth_left, other.growth_left);
+			grtw::swap(hash, other.hash);
+			grtw::swap(equals, other.equals);
+			grtw::swap(get_key, other.get_key);
+		}
+
+		hasher hash_funct() const { return hash; }
+		key_equal key_eq() const { return equals; }
+
+		iterator begin()
+		{
+			iterator it(ctrl, slots);
+			it.skip_free();
+			return it;
+		}
+
+		const_iterator begin() const
+		{
+			const_iterator it(ctrl, slots);
+			it.skip_free();
+			return it;
+		}
+
+		iterator end() { return iterator(ctrl + capacity, slots + capacity); }
+		const_iterator end() const { return const_iterator(ctrl + capacity, slots + capacity); }
+
+		bool empty() const { return count == 0; }
+		size_type size() const { return count; }
+		size_type bucket_count() const { return capacity; }
+
+		//sizes the table so that n elements fit without growing
+		void reserve(size_type n)
+		{
+			if(n > count + growth_left)
+				resize(capacity_for(n));
+		}
+
+		iterator find(const Key& k) { return make_iterator(find_index(k, hash_of(k))); }
+		const_iterator find(const Key& k) const { return make_iterator(find_index(k, hash_of(k))); }
+		size_type count_key(const Key& k) const { return find_index(k, hash_of(k)) == npos ? 0 : 1; }
+
+		//builds the value from args only when k is not in the table yet
+		template<class... Args>
+		pair<iterator, bool> emplace_unique_key(const Key& k, Args&&... args)
+		{
+			size_t h = hash_of(k);
+			size_type i = find_index(k, h);
+			if(i != npos)
+				return pair<iterator, bool>(make_iterator(i), false);
+			i = prepare_insert(h);
+			grtw::construct(slots + i, grtw::forward<Args>(args)...);
+			commit_insert(i, h);
+			return pair<iterator, bool>(make_iterator(i), true);
+		}
+
+		template<class... Args>
+		pair<iterator, bool> emplace_unique(Args&&... args)
+		{
+			Value tmp(grtw::forward<Args>(args)...);
+			return emplace_unique_key(get_key(tmp), grtw::move(tmp));
+		}
+
+		pair<iterator, bool> insert_unique(const Value& v) { return emplace_unique_key(get_key(v), v); }
+		pair<iterator, bool> insert_unique(Value&& v) { return emplace_unique_key(get_key(v), grtw::move(v)); }
+
+		void erase(const_iterator it) { erase_index(it.ctrl - ctrl); }
+
+		size_type erase(const Key& k)
+		{
+			size_type i = find_index(k, hash_of(k));
+			if(i == npos)
+				return 0;
+			erase_index(i);
+			return 1;
+		}
+
+		//destroys the elements and keeps the slots
+		void clear()
+		{
+			destroy_all();
+			if(capacity != 0)
+				memset(ctrl, flat_empty, capacity);
+			count = 0;
+			growth_left = max_load(capacity);
+		}
+	};
+}
+
+#endif
@@ -2,18 +2,108 @@
 #define GRTW_STL_HASH_FUNCTION_H
 
 #include<stddef.h>
+#include<stdint.h>
+#include<string.h>
+#include<string>
 
 namespace grtw
 {
 	template<class Key>
 	struct hash { };
 
+	static const uint64_t hash_p0 = 0xa0761d6478bd642full;
+	static const uint64_t hash_p1 = 0xe7037ed1a0b428dbull;
+	static const uint64_t hash_p2 = 0x8ebc6af09c88c6e3ull;
+	static const uint64_t hash_p3 = 0x589965cc75374cc3ull;
+
+	//64x64 -> 128 bit multiply, folded back to 64 bits
+	inline uint64_t hash_mum(uint64_t a, uint64_t b)
+	{
+		unsigned __int128 r = (unsigned __int128)a * b;
+		return uint64_t(r) ^ uint64_t(r >> 64);
+	}
+
+	inline uint64_t hash_read8(const unsigned char* p)
+	{
+		uint64_t v;
+		memcpy(&v, p, 8);
+		return v;
+	}
+
+	inline uint64_t hash_read4(const unsigned char* p)
+	{
+		uint32_t v;
+		memcpy(&v, p, 4);
+		return v;
+	}
+
+	//splitmix64 finalizer: a bijection, so distinct integers keep distinct hashes, and every
+	//input bit reaches every output bit, low ones included
+	inline size_t hash_mix(uint64_t x)
+	{
+		x ^= x >> 30;
+		x *= 0xbf58476d1ce4e5b9ull;
+		x ^= x >> 27;
+		x *= 0x94d049bb133111ebull;
+		x ^= x >> 31;
+		return size_t(x);
+	}
+
+	//hash_bytes: wyhash, 8 or 16 bytes per multiply; keys up to 16 bytes take no loop at all
+	inline size_t hash_bytes(const void* key, size_t len, size_t seed = 0)
+	{
+		const unsigned char* p = static_cast<const unsigned char*>(key);
+		uint64_t s = seed ^ hash_mum(seed ^ hash_p0, hash_p1);
+		uint64_t a, b;
+		if(len <= 16)
+		{
+			if(len >= 4)
+			{
+				size_t mid = (len >> 3) << 2;
+				a = (hash_read4(p) << 32) | hash_read4(p + mid);
+				b = (hash_read4(p + len - 4) << 32) | hash_read4(p + len - 4 - mid);
+			}
+			else if(len > 0)
+			{
+				a = (uint64_t(p[0]) << 16) | (uint64_t(p[len >> 1]) << 8) | p[len - 1];
+				b = 0;
+			}
+			else
+				a = b = 0;
+		}
+		else
+		{
+			size_t i = len;
+			if(i > 48)
+			{
+				uint64_t s1 = s;
+				uint64_t s2 = s;
+				do
+				{
+					s = hash_mum(hash_read8(p) ^ hash_p1, hash_read8(p + 8) ^ s);
+					s1 = hash_mum(hash_read8(p + 16) ^ hash_p2, hash_read8(p + 24) ^ s1);
+					s2 = hash_mum(hash_read8(p + 32) ^ hash_p3, hash_read8(p + 40) ^ s2);
+					p += 48;
+					i -= 48;
+				} while(i > 48);
+				s ^= s1 ^ s2;
+			}
+			while(i > 16)
+			{
+				s = hash_mum(hash_read8(p) ^ hash_p1, hash_read8(p + 8) ^ s);
+				p += 16;
+				i -= 16;
+			}
+			a = hash_read8(p + i - 16);
+			b = hash_read8(p + i - 8);
+		}
+		unsigned __int128 r = (unsigned __int128)(a ^ hash_p1) * (b ^ s);
+		return size_t(hash_mum(uint64_t(r) ^ hash_p0 ^ len, uint64_t(r >> 64) ^ hash_p1));
+	}
+
 	inline size_t stl_hash_string(const char* s)
 	{
-		unsigned long h = 0;
-		for(; *s; ++s)
-			h = 5 * h + *s;
-		return size_t(h);
+		return hash_bytes(s, strlen(s));
 	}
 
 	template<>
@@ -34,12 +124,32 @@ namespace grtw
 		}
 	};
 
+	template<>
+	struct hash<std::string>
+	{
+		size_t operator()(const std::string& s) const
+		{
+			return hash_bytes(s.data(), s.size());
+		}
+	};
+
+	//integers are mixed rather than returned as is, which would put consecutive keys in
+	//consecutive buckets and leave the high bits of small keys zero
+	template<>
+	struct hash<bool>
+	{
+		size_t operator()(bool c) const
+		{
+			return hash_mix(c);
+		}
+	};
+
 	template<>
 	struct hash<char>
 	{
 		size_t operator()(char c) const
 		{
-			return c;
+			return hash_mix(c);
 		}
 	};
 
@@ -48,7 +158,7 @@ namespace grtw
 	{
 		size_t operator()(unsigned char c) const
 		{
-			return c;
+			return hash_mix(c);
 		}
 	};
 
@@ -57,7 +167,34 @@ namespace grtw
 	{
 		size_t operator()(signed char c) const
 		{
-			return c;
+			return hash_mix(c);
+		}
+	};
+
+	template<>
+	struct hash<wchar_t>
+	{
+		size_t operator()(wchar_t c) const
+		{
+			return hash_mix(c);
+		}
+	};
+
+	template<>
+	struct hash<char16_t>
+	{
+		size_t operator()(char16_t c) const
+		{
+			return hash_mix(c);
+		}
+	};
+
+	template<>
+	struct hash<char32_t>
+	{
+		size_t operator()(char32_t c) const
+		{
+			return hash_mix(c);
 		}
 	};
 
@@ -66,7 +203,7 @@ namespace grtw
 	{
 		size_t operator()(short c) const
 		{
-			return c;
+			return hash_mix(c);
 		}
 	};
 
@@ -75,7 +212,7 @@ namespace grtw
 	{
 		size_t operator()(unsigned short c) const
 		{
-			return c;
+			return hash_mix(c);
 		}
 	};
 
@@ -84,7 +221,7 @@ namespace grtw
 	{
 		size_t operator()(int c) const
 		{
-			return c;
+			return hash_mix(c);
 		}
 	};
 
@@ -93,7 +230,7 @@ namespace grtw
 	{
 		size_t operator()(unsigned int c) const
 		{
-			return c;
+			return hash_mix(c);
 		}
 	};
 
@@ -102,7 +239,7 @@ namespace grtw
 	{
 		size_t operator()(long c) const
 		{
-			return c;
+			return hash_mix(c);
 		}
 	};
 
@@ -111,9 +248,118 @@ namespace grtw
 	{
 		size_t operator()(unsigned long c) const
 		{
-			return c;
+			return hash_mix(c);
+		}
+	};
+
+	template<>
+	struct hash<long long>
+	{
+		size_t operator()(long long c) const
+		{
+			return hash_mix(c);
+		}
+	};
+
+	template<>
+	struct hash<unsigned long long>
+	{
+		size_t operator()(unsigned long long c) const
+		{
+			return hash_mix(c);
+		}
+	};
+
+	//pointers are aligned, so their low bits carry nothing until mixed
+	template<class T>
+	struct hash<T*>
+	{
+		size_t operator()(T* p) const
+		{
+			return hash_mix(reinterpret_cast<uintptr_t>(p));
+		}
+	};
+
+	//0.0 and -0.0 compare equal, so they must hash alike
+	template<>
+	struct hash<float>
+	{
+		size_t operator()(float f) const
+		{
+			if(f == 0.0f)
+				return hash_mix(0);
+			uint32_t bits;
+			memcpy(&bits, &f, sizeof(bits));
+			return hash_mix(bits);
+		}
+	};
+
+	template<>
+	struct hash<double>
+	{
+		size_t operator()(double d) const
+		{
+			if(d == 0.0)
+				return hash_mix(0);
+			uint64_t bits;
+			memcpy(&bits, &d, sizeof(bits));
+			return hash_mix(bits);
+		}
+	};
+
+	//seeded_hash: hash<Key> keyed with a per-table seed, so inputs crafted to collide under
+	//one seed do not collide under another; strings feed the seed into hash_bytes itself
+	template<class Key>
+	struct seeded_hash
+	{
+		size_t seed;
+
+		explicit seeded_hash(size_t s = hash_p2) : seed(s) {}
+
+		size_t operator()(const Key& k) const
+		{
+			return hash_mix(hash<Key>()(k) ^ seed);
+		}
+	};
+
+	template<>
+	struct seeded_hash<std::string>
+	{
+		size_t seed;
+
+		explicit seeded_hash(size_t s = hash_p2) : seed(s) {}
+
+		size_t operator()(const std::string& s) const
+		{
+			return hash_bytes(s.data(), s.size(), seed);
+		}
+	};
+
+	template<>
+	struct seeded_hash<const char*>
+	{
+		size_t seed;
+
+		explicit seeded_hash(size_t s = hash_p2) : seed(s) {}
+
+		size_t operator()(const char* s) const
+		{
+			return hash_bytes(s, strlen(s), seed);
+		}
+	};
+
+	template<>
+	struct seeded_hash<char*>
+	{
+		size_t seed;
+
+		explicit seeded_hash(size_t s = hash_p2) : seed(s) {}
+
+		size_t operator()(const char* s) const
+		{
+			return hash_bytes(s, strlen(s), seed);
 		}
 	};
 }
 
-#endif
\ No newline at end of file
+#endif
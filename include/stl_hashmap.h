@@ -1,9 +1,203 @@
 #ifndef GRTW_STL_HASHMAP_H
 #define GRTW_STL_HASHMAP_H
 
+#include"stl_function.h"
+#include"stl_hash_function.h"
+#include"stl_hashtable.h"
+#include"stl_pair.h"
+#include"stl_utility.h"
+
 namespace grtw
 {
+	template<class Key, class Value, class HashFcn = hash<Key>, class EqualKey = equal_to<Key>, class Alloc = default_alloc>
+	class hash_map
+	{
+	private:
+		using value_type = pair<const Key, Value>;
+		using repo_type = hashtable<value_type, Key, HashFcn, select1st<value_type>, EqualKey, Alloc>;
+
+	public:
+		using key_type = Key;
+		using mapped_type = Value;
+		using hasher = typename repo_type::hasher;
+		using key_equal = typename repo_type::key_equal;
+		using pointer = typename repo_type::pointer;
+		using const_pointer = typename repo_type::const_pointer;
+		using reference = typename repo_type::reference;
+		using const_reference = typename repo_type::const_reference;
+		using iterator = typename repo_type::iterator;
+		using const_iterator = typename repo_type::const_iterator;
+		using size_type = typename repo_type::size_type;
+		using difference_type = typename repo_type::difference_type;
+
+	private:
+		repo_type repository;
+
+	public:
+		hash_map() : repository(100, hasher(), key_equal()) {}
+		explicit hash_map(size_type n) : repository(n, hasher(), key_equal()) {}
+		hash_map(size_type n, const hasher& hf) : repository(n, hf, key_equal()) {}
+		hash_map(size_type n, const hasher& hf, const key_equal& eql) : repository(n, hf, eql) {}
+		hash_map(const value_type* vfirst, const value_type* vlast, size_type n = 100) : repository(n, hasher(), key_equal()) { repository.insert_unique(vfirst, vlast); }
+		hash_map(const_iterator vfirst, const_iterator vlast, size_type n = 100) : repository(n, hasher(), key_equal()) { repository.insert_unique(vfirst, vlast); }
+		hash_map(const hash_map& other) : repository(other.repository) {}
+		hash_map(hash_map&& other) : repository(grtw::move(other.repository)) {}
+
+		hash_map& operator=(const hash_map& other)
+		{
+			repository = other.repository;
+			return *this;
+		}
+
+		hash_map& operator=(hash_map&& other)
+		{
+			repository = grtw::move(other.repository);
+			return *this;
+		}
+
+		void swap(hash_map& other) noexcept { repository.swap(other.repository); }
+
+		hasher hash_funct() const { return repository.hash_funct(); }
+		key_equal key_eq() const { return repository.key_eq(); }
+
+		iterator begin() { return repository.begin(); }
+		const_iterator begin() const { return repository.begin(); }
+		iterator end() { return repository.end(); }
+		const_iterator end() const { return repository.end(); }
+		bool empty() const { return repository.empty(); }
+		size_type size() const { return repository.size(); }
+		size_type max_size() const { return repository.max_size(); }
+
+		Value& operator[](const Key& k) { return try_emplace(k).first->second; }
+		Value& operator[](Key&& k) { return try_emplace(grtw::move(k)).first->second; }
+
+		pair<iterator, bool> insert(const value_type& x) { return repository.insert_unique(x); }
+		pair<iterator, bool> insert(value_type&& x) { return repository.insert_unique(grtw::move(x)); }
+		pair<iterator, bool> insert_noresize(const value_type& x) { return repository.insert_unique_noresize(x); }
+		void insert(const value_type* vfirst, const value_type* vlast) { repository.insert_unique(vfirst, vlast); }
+		void insert(const_iterator vfirst, const_iterator vlast) { repository.insert_unique(vfirst, vlast); }
+
+		template<class... Args>
+		pair<iterator, bool> emplace(Args&&... args) { return repository.emplace_unique(grtw::forward<Args>(args)...); }
+
+		//the mapped value is only built when k is not present yet, args are left alone otherwise
+		template<class... Args>
+		pair<iterator, bool> try_emplace(const Key& k, Args&&... args)
+		{
+			return repository.emplace_unique_key(k, pair_emplace_t(), k, grtw::forward<Args>(args)...);
+		}
+
+		template<class... Args>
+		pair<iterator, bool> try_emplace(Key&& k, Args&&... args)
+		{
+			return repository.emplace_unique_key(k, pair_emplace_t(), grtw::move(k), grtw::forward<Args>(args)...);
+		}
+
+		void erase(const_iterator it) { repository.erase(it); }
+		size_type erase(const Key& k) { return repository.erase(k); }
+		void erase(const_iterator vfirst, const_iterator vlast) { repository.erase(vfirst, vlast); }
+
+		void clear() { repository.clear(); }
+
+		iterator find(const Key& k) { return repository.find(k); }
+		const_iterator find(const Key& k) const { return repository.find(k); }
+		size_type count(const Key& k) const { return repository.count(k); }
+		pair<iterator, iterator> equal_range(const Key& k) { return repository.equal_range(k); }
+		pair<const_iterator, const_iterator> equal_range(const Key& k) const { return repository.equal_range(k); }
+
+		void resize(size_type hint) { repository.resize(hint); }
+		void reserve(size_type n) { repository.reserve(n); }
+		size_type bucket_count() const { return repository.bucket_count(); }
+		size_type max_bucket_count() const { return repository.max_bucket_count(); }
+		size_type elems_in_bucket(size_type n) const { return repository.elems_in_bucket(n); }
+	};
+
+	template<class Key, class Value, class HashFcn = hash<Key>, class EqualKey = equal_to<Key>, class Alloc = default_alloc>
+	class hash_multimap
+	{
+	private:
+		using value_type = pair<const Key, Value>;
+		using repo_type = hashtable<value_type, Key, HashFcn, select1st<value_type>, EqualKey, Alloc>;
+
+	public:
+		using key_type = Key;
+		using mapped_type = Value;
+		using hasher = typename repo_type::hasher;
+		using key_equal = typename repo_type::key_equal;
+		using pointer = typename repo_type::pointer;
+		using const_pointer = typename repo_type::const_pointer;
+		using reference = typename repo_type::reference;
+		using const_reference = typename repo_type::const_reference;
+		using iterator = typename repo_type::iterator;
+		using const_iterator = typename repo_type::const_iterator;
+		using size_type = typename repo_type::size_type;
+		using difference_type = typename repo_type::difference_type;
+
+	private:
+		repo_type repository;
+
+	public:
+		hash_multimap() : repository(100, hasher(), key_equal()) {}
+		explicit hash_multimap(size_type n) : repository(n, hasher(), key_equal()) {}
+		hash_multimap(size_type n, const hasher& hf) : repository(n, hf, key_equal()) {}
+		hash_multimap(size_type n, const hasher& hf, const key_equal& eql) : repository(n, hf, eql) {}
+		hash_multimap(const value_type* vfirst, const value_type* vlast, size_type n = 100) : repository(n, hasher(), key_equal()) { repository.insert_equal(vfirst, vlast); }
+		hash_multimap(const_iterator vfirst, const_iterator vlast, size_type n = 100) : repository(n, hasher(), key_equal()) { repository.insert_equal(vfirst, vlast); }
+		hash_multimap(const hash_multimap& other) : repository(other.repository) {}
+		hash_multimap(hash_multimap&& other) : repository(grtw::move(other.repository)) {}
+
+		hash_multimap& operator=(const hash_multimap& other)
+		{
+			repository = other.repository;
+			return *this;
+		}
+
+		hash_multimap& operator=(hash_multimap&& other)
+		{
+			repository = grtw::move(other.repository);
+			return *this;
+		}
+
+		void swap(hash_multimap& other) noexcept { repository.swap(other.repository); }
+
+		hasher hash_funct() const { return repository.hash_funct(); }
+		key_equal key_eq() const { return repository.key_eq(); }
+
+		iterator begin() { return repository.begin(); }
+		const_iterator begin() const { return repository.begin(); }
+		iterator end() { return repository.end(); }
+		const_iterator end() const { return repository.end(); }
+		bool empty() const { return repository.empty(); }
+		size_type size() const { return repository.size(); }
+		size_type max_size() const { return repository.max_size(); }
+
+		iterator insert(const value_type& x) { return repository.insert_equal(x); }
+		iterator insert(value_type&& x) { return repository.insert_equal(grtw::move(x)); }
+		iterator insert_noresize(const value_type& x) { return repository.insert_equal_noresize(x); }
+		void insert(const value_type* vfirst, const value_type* vlast) { repository.insert_equal(vfirst, vlast); }
+		void insert(const_iterator vfirst, const_iterator vlast) { repository.insert_equal(vfirst, vlast); }
+
+		template<class... Args>
+		iterator emplace(Args&&... args) { return repository.emplace_equal(grtw::forward<Args>(args)...); }
+
+		void erase(const_iterator it) { repository.erase(it); }
+		size_type erase(const Key& k) { return repository.erase(k); }
+		void erase(const_iterator vfirst, const_iterator vlast) { repository.erase(vfirst, vlast); }
+
+		void clear() { repository.clear(); }
+
+		iterator find(const Key& k) { return repository.find(k); }
+		const_iterator find(const Key& k) const { return repository.find(k); }
+		size_type count(const Key& k) const { return repository.count(k); }
+		pair<iterator, iterator> equal_range(const Key& k) { return repository.equal_range(k); }
+		pair<const_iterator, const_iterator> equal_range(const Key& k) const { return repository.equal_range(k); }
 
+		void resize(size_type hint) { repository.resize(hint); }
+		void reserve(size_type n) { repository.reserve(n); }
+		size_type bucket_count() const { return repository.bucket_count(); }
+		size_type max_bucket_count() const { return repository.max_bucket_count(); }
+		size_type elems_in_bucket(size_type n) const { return repository.elems_in_bucket(n); }
+	};
 }
 
-#endif
\ No newline at end of file
+#endif
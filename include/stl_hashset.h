@@ -1,9 +1,197 @@
 #ifndef GRTW_STL_HASHSET_H
 #define GRTW_STL_HASHSET_H
 
+#include"stl_function.h"
+#include"stl_hash_function.h"
+#include"stl_hashtable.h"
+#include"stl_pair.h"
+#include"stl_utility.h"
+
 namespace grtw
 {
+	template<class Key, class HashFcn = hash<Key>, class EqualKey = equal_to<Key>, class Alloc = default_alloc>
+	class hash_set
+	{
+	private:
+		using value_type = Key;
+		using repo_type = hashtable<Key, Key, HashFcn, identity<Key>, EqualKey, Alloc>;
+
+	public:
+		using key_type = Key;
+		using hasher = typename repo_type::hasher;
+		using key_equal = typename repo_type::key_equal;
+		using pointer = typename repo_type::const_pointer;
+		using const_pointer = typename repo_type::const_pointer;
+		using reference = typename repo_type::const_reference;
+		using const_reference = typename repo_type::const_reference;
+		using iterator = typename repo_type::const_iterator;
+		using const_iterator = typename repo_type::const_iterator;
+		using size_type = typename repo_type::size_type;
+		using difference_type = typename repo_type::difference_type;
+
+	private:
+		repo_type repository;
+
+	public:
+		hash_set() : repository(100, hasher(), key_equal()) {}
+		explicit hash_set(size_type n) : repository(n, hasher(), key_equal()) {}
+		hash_set(size_type n, const hasher& hf) : repository(n, hf, key_equal()) {}
+		hash_set(size_type n, const hasher& hf, const key_equal& eql) : repository(n, hf, eql) {}
+		hash_set(const value_type* vfirst, const value_type* vlast, size_type n = 100) : repository(n, hasher(), key_equal()) { repository.insert_unique(vfirst, vlast); }
+		hash_set(const_iterator vfirst, const_iterator vlast, size_type n = 100) : repository(n, hasher(), key_equal()) { repository.insert_unique(vfirst, vlast); }
+		hash_set(const hash_set& other) : repository(other.repository) {}
+		hash_set(hash_set&& other) : repository(grtw::move(other.repository)) {}
+
+		hash_set& operator=(const hash_set& other)
+		{
+			repository = other.repository;
+			return *this;
+		}
+
+		hash_set& operator=(hash_set&& other)
+		{
+			repository = grtw::move(other.repository);
+			return *this;
+		}
+
+		void swap(hash_set& other) noexcept { repository.swap(other.repository); }
+
+		hasher hash_funct() const { return repository.hash_funct(); }
+		key_equal key_eq() const { return repository.key_eq(); }
+
+		iterator begin() const { return repository.begin(); }
+		iterator end() const { return repository.end(); }
+		bool empty() const { return repository.empty(); }
+		size_type size() const { return repository.size(); }
+		size_type max_size() const { return repository.max_size(); }
+
+		pair<iterator, bool> insert(const value_type& x)
+		{
+			pair<typename repo_type::iterator, bool> p = repository.insert_unique(x);
+			return pair<iterator, bool>(p.first, p.second);
+		}
+
+		pair<iterator, bool> insert(value_type&& x)
+		{
+			pair<typename repo_type::iterator, bool> p = repository.insert_unique(grtw::move(x));
+			return pair<iterator, bool>(p.first, p.second);
+		}
+
+		pair<iterator, bool> insert_noresize(const value_type& x)
+		{
+			pair<typename repo_type::iterator, bool> p = repository.insert_unique_noresize(x);
+			return pair<iterator, bool>(p.first, p.second);
+		}
+
+		template<class... Args>
+		pair<iterator, bool> emplace(Args&&... args)
+		{
+			pair<typename repo_type::iterator, bool> p = repository.emplace_unique(grtw::forward<Args>(args)...);
+			return pair<iterator, bool>(p.first, p.second);
+		}
+
+		void insert(const value_type* vfirst, const value_type* vlast) { repository.insert_unique(vfirst, vlast); }
+		void insert(const_iterator vfirst, const_iterator vlast) { repository.insert_unique(vfirst, vlast); }
+
+		void erase(iterator it) { repository.erase(it); }
+		size_type erase(const Key& k) { return repository.erase(k); }
+		void erase(iterator vfirst, iterator vlast) { repository.erase(vfirst, vlast); }
+
+		void clear() { repository.clear(); }
+
+		iterator find(const Key& k) const { return repository.find(k); }
+		size_type count(const Key& k) const { return repository.count(k); }
+		pair<iterator, iterator> equal_range(const Key& k) const { return repository.equal_range(k); }
+
+		void resize(size_type hint) { repository.resize(hint); }
+		void reserve(size_type n) { repository.reserve(n); }
+		size_type bucket_count() const { return repository.bucket_count(); }
+		size_type max_bucket_count() const { return repository.max_bucket_count(); }
+		size_type elems_in_bucket(size_type n) const { return repository.elems_in_bucket(n); }
+	};
+
+	template<class Key, class HashFcn = hash<Key>, class EqualKey = equal_to<Key>, class Alloc = default_alloc>
+	class hash_multiset
+	{
+	private:
+		using value_type = Key;
+		using repo_type = hashtable<Key, Key, HashFcn, identity<Key>, EqualKey, Alloc>;
+
+	public:
+		using key_type = Key;
+		using hasher = typename repo_type::hasher;
+		using key_equal = typename repo_type::key_equal;
+		using pointer = typename repo_type::const_pointer;
+		using const_pointer = typename repo_type::const_pointer;
+		using reference = typename repo_type::const_reference;
+		using const_reference = typename repo_type::const_reference;
+		using iterator = typename repo_type::const_iterator;
+		using const_iterator = typename repo_type::const_iterator;
+		using size_type = typename repo_type::size_type;
+		using difference_type = typename repo_type::difference_type;
+
+	private:
+		repo_type repository;
+
+	public:
+		hash_multiset() : repository(100, hasher(), key_equal()) {}
+		explicit hash_multiset(size_type n) : repository(n, hasher(), key_equal()) {}
+		hash_multiset(size_type n, const hasher& hf) : repository(n, hf, key_equal()) {}
+		hash_multiset(size_type n, const hasher& hf, const key_equal& eql) : repository(n, hf, eql) {}
+		hash_multiset(const value_type* vfirst, const value_type* vlast, size_type n = 100) : repository(n, hasher(), key_equal()) { repository.insert_equal(vfirst, vlast); }
+		hash_multiset(const_iterator vfirst, const_iterator vlast, size_type n = 100) : repository(n, hasher(), key_equal()) { repository.insert_equal(vfirst, vlast); }
+		hash_multiset(const hash_multiset& other) : repository(other.repository) {}
+		hash_multiset(hash_multiset&& other) : repository(grtw::move(other.repository)) {}
+
+		hash_multiset& operator=(const hash_multiset& other)
+		{
+			repository = other.repository;
+			return *this;
+		}
+
+		hash_multiset& operator=(hash_multiset&& other)
+		{
+			repository = grtw::move(other.repository);
+			return *this;
+		}
+
+		void swap(hash_multiset& other) noexcept { repository.swap(other.repository); }
+
+		hasher hash_funct() const { return repository.hash_funct(); }
+		key_equal key_eq() const { return repository.key_eq(); }
+
+		iterator begin() const { return repository.begin(); }
+		iterator end() const { return repository.end(); }
+		bool empty() const { return repository.empty(); }
+		size_type size() const { return repository.size(); }
+		size_type max_size() const { return repository.max_size(); }
+
+		iterator insert(const value_type& x) { return repository.insert_equal(x); }
+		iterator insert(value_type&& x) { return repository.insert_equal(grtw::move(x)); }
+		iterator insert_noresize(const value_type& x) { return repository.insert_equal_noresize(x); }
+
+		template<class... Args>
+		iterator emplace(Args&&... args) { return repository.emplace_equal(grtw::forward<Args>(args)...); }
+
+		void insert(const value_type* vfirst, const value_type* vlast) { repository.insert_equal(vfirst, vlast); }
+		void insert(const_iterator vfirst, const_iterator vlast) { repository.insert_equal(vfirst, vlast); }
+
+		void erase(iterator it) { repository.erase(it); }
+		size_type erase(const Key& k) { return repository.erase(k); }
+		void erase(iterator vfirst, iterator vlast) { repository.erase(vfirst, vlast); }
+
+		void clear() { repository.clear(); }
+
+		iterator find(const Key& k) const { return repository.find(k); }
+		size_type count(const Key& k) const { return repository.count(k); }
+		pair<iterator, iterator> equal_range(const Key& k) const { return repository.equal_range(k); }
 
+		void resize(size_type hint) { repository.resize(hint); }
+		void reserve(size_type n) { repository.reserve(n); }
+		size_type bucket_count() const { return repository.bucket_count(); }
+		size_type max_bucket_count() const { return repository.max_bucket_count(); }
+		size_type elems_in_bucket(size_type n) const { return repository.elems_in_bucket(n); }
+	};
 }
 
-#endif
\ No newline at end of file
+#endif
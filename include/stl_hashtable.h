@@ -1,9 +1,1147 @@
 #ifndef GRTW_STL_HASHTABLE_H
 #define GRTW_STL_HASHTABLE_H
 
+#include<cstddef>
+#include"stl_iterator_base.h"
+#include"stl_alloc.h"
+#include"stl_allocator.h"
+#include"stl_construct.h"
+#include"stl_vector.h"
+#include"stl_pair.h"
+#include"stl_utility.h"
+
 namespace grtw
 {
+	template<class Value>
+	struct hashtable_node
+	{
+		hashtable_node* next;
+		Value val;
+	};
+
+	template<class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+	class hashtable;
+
+	template<class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc, class Reference, class Pointer>
+	struct hashtable_iterator
+	{
+		using iterator_category = forward_iterator_tag;
+		using value_type = Value;
+		using difference_type = ptrdiff_t;
+		using reference = Reference;
+		using pointer = Pointer;
+
+		using Self = hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc, Reference, Pointer>;
+		using iterator = hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc, Value&, Value*>;
+		using table = hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>;
+		using node = hashtable_node<Value>;
+
+		node* cur;
+		const table* ht;
+
+		hashtable_iterator() : cur(nullptr), ht(nullptr) {}
+		hashtable_iterator(node* n, const table* t) : cur(n), ht(t) {}
+		hashtable_iterator(const iterator& x) : cur(x.cur), ht(x.ht) {}
+
+		reference operator*() const { return cur->val; }
+		pointer operator->() const { return &(operator*()); }
+
+		//the end of a chain continues with the next non-empty bucket
+		Self& operator++()
+		{
+			const node* old = cur;
+			cur = cur->next;
+			if(cur == nullptr)
+			{
+				size_t bucket = ht->bkt_num(old->val);
+				while(cur == nullptr && ++bucket < ht->buckets.size())
+					cur = ht->buckets[bucket];
+			}
+			return *this;
+		}
+
+		Self operator++(int)
+		{
+			Self tmp = *this;
+			++*this;
+			return tmp;
+		}
+
+		bool operator==(const Self& x) const { return cur == x.cur; }
+		bool operator!=(const Self& x) const { return cur != x.cur; }
+	};
+
+	//bucket counts are primes, each roughly twice the previous one
+	static const int stl_num_primes = 28;
+	static const unsigned long stl_prime_list[stl_num_primes] =
+	{
+		53ul,         97ul,         193ul,       389ul,       769ul,
+		1543ul,       3079ul,       6151ul,      12289ul,     24593ul,
+		49157ul,      98317ul,      196613ul,    393241ul,    786433ul,
+		1572869ul,    3145739ul,    6291469ul,   12582917ul,  25165843ul,
+		50331653ul,   100663319ul,  201326611ul, 402653189ul, 805306457ul,
+		1610612741ul, 3221225473ul, 4294967291ul
+	};
+
+	inline unsigned long stl_next_prime(unsigned long n)
+	{
+		for(int i = 0; i < stl_num_primes; ++i)
+			if(stl_prime_list[i] >= n)
+				return stl_prime_list[i];
+		return stl_prime_list[stl_num_primes - 1];
+	}
+
+	//hashtable: SGI's separate chaining table. The buckets are a vector of chain heads, nodes
+	//come from Alloc (default_alloc keeps freed nodes on its free lists for reuse), and the
+	//bucket count grows to the next prime once there are more elements than buckets;
+	//resize(n) up front makes the next n inserts rehash-free
+	template<class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc = default_alloc>
+	class hashtable
+	{
+	public:
+		using key_type = Key;
+		using value_type = Value;
+		using hasher = HashFcn;
+		using key_equal = EqualKey;
+		using size_type = size_t;
+		using difference_type = ptrdiff_t;
+		using pointer = value_type*;
+		using const_pointer = const value_type*;
+		using reference = value_type&;
+		using const_reference = const value_type&;
+
+		using iterator = hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc, Value&, Value*>;
+		using const_iterator = hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc, const Value&, const Value*>;
+
+		template<class, class, class, class, class, class, class, class>
+		friend struct hashtable_iterator;
+
+	private:
+		using node = hashtable_node<Value>;
+		using node_alloc = allocator<node, Alloc>;
+
+		hasher hash;
+		key_equal equals;
+		ExtractKey get_key;
+		vector<node*> buckets;
+		size_type num_elements;
+
+		template<class... Args>
+		node* new_node(Args&&... args)
+		{
+			node* n = node_alloc::allocate();
+			grtw::construct(&n->val, grtw::forward<Args>(args)...);
+			n->next = nullptr;
+			return n;
+		}
+
+		void delete_node(node* n)
+		{
+			grtw::destroy(&n->val);
+			node_alloc::deallocate(n);
+		}
+
+		size_type next_size(size_type n) const { return stl_next_prime(n); }
+
+		void initialize_buckets(size_type n)
+		{
+			buckets.resize(next_size(n), nullptr);
+			num_elements = 0;
+		}
+
+		size_type bkt_num_key(const Key& k, size_type n) const { return hash(k) % n; }
+		size_type bkt_num_key(const Key& k) const { return bkt_num_key(k, buckets.size()); }
+		size_type bkt_num(const Value& v, size_type n) const { return bkt_num_key(get_key(v), n); }
+		size_type bkt_num(const Value& v) const { return bkt_num_key(get_key(v)); }
+
+		//links a new node into bucket n; equal keys are kept next to each other
+		iterator link_equal(node* tmp, size_type n)
+		{
+			node* first = buckets[n];
+			for(node* cur = first; cur != nullptr; cur = cur->next)
+			{
+				if(equals(get_key(cur->val), get_key(tmp->val)))
+				{
+					tmp->next = cur->next;
+					cur->next = tmp;
+					++num_elements;
+					return iterator(tmp, this);
+				}
+			}
+			tmp->next = first;
+			buckets[n] = tmp;
+			++num_elements;
+			return iterator(tmp, this);
+		}
+
+		void copy_from(const hashtable& other)
+		{
+			buckets.clear();
+			buckets.resize(other.buckets.size(), nullptr);
+			for(size_type i = 0; i < other.buckets.size(); ++i)
+			{
+				const node* cur = other.buckets[i];
+				if(cur != nullptr)
+				{
+					node* copy = new_node(cur->val);
+					buckets[i] = copy;
+					for(node* next = cur->next; next != nullptr; cur = next, next = cur->next)
+					{
+						copy->next = new_node(next->val);
+						copy = copy->next;
+					}
+				}
+			}
+			num_elements = other.num_elements;
+		}
+
+		void erase_bucket(size_type n, node* first, node* last)
+		{
+			node* cur = buckets[n];
+			if(cur == first)
+				erase_bucket(n, last);
+			else
+			{
+				node* next;
+				for(next = cur->next; next != first; cur = next, next = cur->next)
+					;
+				while(next != last)
+				{
+					cur->next = next->next;
+					delete_node(next);
+					next = cur->next;
+					--num_elements;
+				}
+			}
+		}
+
+		void erase_bucket(size_type n, node* last)
+		{
+			node* cur = buckets[n];
+			while(cur != last)
+			{
+				node* next = cur->next;
+				delete_node(cur);
+				cur = next;
+				buckets[n] = cur;
+				--num_elements;
+			}
+		}
+
+	public:
+		hashtable(size_type n, const hasher& hf, const key_equal& eql) : hash(hf), equals(eql), get_key(), num_elements(0)
+		{
+			initialize_buckets(n);
+		}
+
+		hashtable(const hashtable& other) : hash(other.hash), equals(other.equals), get_key(other.get_key), num_elements(0)
+		{
+			copy_from(other);
+		}
+
+		hashtable(hashtable&& other) : hash(other.hash), equals(other.equals), get_key(other.get_key),
+			buckets(grtw::move(other.buckets)), num_elements(other.num_elements)
+		{
+			other.initialize_buckets(0);
+		}
+
+		hashtable& operator=(const hashtable& other)
+		{
+			if(this != &other)
+			{
+				clear();
+				hash = other.hash;
+				equals = other.equals;
+				get_key = other.get_key;
+				copy_from(other);
+			}
+			return *this;
+		}
+
+		hashtable& operator=(hashtable&& other)
+		{
+			if(this != &other)
+			{
+				clear();
+				swap(other);
+			}
+			return *this;
+		}
+
+		~hashtable() { clear(); }
+
+		void swap(hashtable& other) noexcept
+		{
+			grtw::swap(hash, other.hash);
+			grtw::swap(equals, other.equals);
+			grtw::swap(get_key, other.get_key);
+			buckets.swap(other.buckets);
+			grtw::swap(num_elements, other.num_elements);
+		}
+
+		hasher hash_funct() const { return hash; }
+		key_equal key_eq() const { return equals; }
+
+		size_type size() const { return num_elements; }
+		size_type max_size() const { return size_type(-1); }
+		bool empty() const { return num_elements == 0; }
+
+		iterator begin()
+		{
+			for(size_type n = 0; n < buckets.size(); ++n)
+				if(buckets[n] != nullptr)
+					return iterator(buckets[n], this);
+			return end();
+		}
+
+		const_iterator begin() const
+		{
+			for(size_type n = 0; n < buckets.size(); ++n)
+				if(buckets[n] != nullptr)
+					return const_iterator(buckets[n], this);
+			return end();
+		}
+
+		iterator end() { return iterator(nullptr, this); }
+		const_iterator end() const { return const_iterator(nullptr, this); }
+
+		size_type bucket_count() const { return buckets.size(); }
+		size_type max_bucket_count() const { return stl_prime_list[stl_num_primes - 1]; }
+
+		size_type elems_in_bucket(size_type n) const
+		{
+			size_type result = 0;
+			for(node* cur = buckets[n]; cur != nullptr; cur = cur->next)
+				++result;
+			return result;
+		}
+
+		pair<iterator, bool> insert_unique(const value_type& v)
+		{
+			resize(num_elements + 1);
+			return insert_unique_noresize(v);
+		}
+
+		iterator insert_equal(const value_type& v)
+		{
+			resize(num_elements + 1);
+			return insert_equal_noresize(v);
+		}
+
+		pair<iterator, bool> insert_unique(value_type&& v) { return emplace_unique_key(get_key(v), grtw::move(v)); }
+		iterator insert_equal(value_type&& v) { return emplace_equal(grtw::move(v)); }
+
+		pair<iterator, bool> insert_unique_noresize(const value_type& v)
+		{
+			size_type n = bkt_num(v);
+			node* first = buckets[n];
+			for(node* cur = first; cur != nullptr; cur = cur->next)
+				if(equals(get_key(cur->val), get_key(v)))
+					return pair<iterator, bool>(iterator(cur, this), false);
+			node* tmp = new_node(v);
+			tmp->next = first;
+			buckets[n] = tmp;
+			++num_elements;
+			return pair<iterator, bool>(iterator(tmp, this), true);
+		}
+
+		iterator insert_equal_noresize(const value_type& v) { return link_equal(new_node(v), bkt_num(v)); }
+
+		template<class InputIterator>
+		void insert_unique(InputIterator first, InputIterator last)
+		{
+			for(; first != last; ++first)
+				insert_unique(*first);
+		}
+
+		template<class InputIterator>
+		void insert_equal(InputIterator first, InputIterator last)
+		{
+			for(; first != last; ++first)
+				insert_equal(*first);
+		}
+
+		//builds the node from args only when k is not in the table yet
+		template<class... Args>
+		pair<iterator, bool> emplace_unique_key(const Key& k, Args&&... args)
+		{
+			iterator it = find(k);
+			if(it != end())
+				return pair<iterator, bool>(it, false);
+			node* tmp = new_node(grtw::forward<Args>(args)...);
+			resize(num_elements + 1);
+			size_type n = bkt_num(tmp->val);
+			tmp->next = buckets[n];
+			buckets[n] = tmp;
+			++num_elements;
+			return pair<iterator, bool>(iterator(tmp, this), true);
+		}
+
+		template<class... Args>
+		pair<iterator, bool> emplace_unique(Args&&... args)
+		{
+			node* tmp = new_node(grtw::forward<Args>(args)...);
+			iterator it = find(get_key(tmp->val));
+			if(it != end())
+			{
+				delete_node(tmp);
+				return pair<iterator, bool>(it, false);
+			}
+			resize(num_elements + 1);
+			size_type n = bkt_num(tmp->val);
+			tmp->next = buckets[n];
+			buckets[n] = tmp;
+			++num_elements;
+			return pair<iterator, bool>(iterator(tmp, this), true);
+		}
+
+		template<class... Args>
+		iterator emplace_equal(Args&&... args)
+		{
+			node* tmp = new_node(grtw::forward<Args>(args)...);
+			resize(num_elements + 1);
+			return link_equal(tmp, bkt_num(tmp->val));
+		}
+
+		reference find_or_insert(const value_type& v)
+		{
+			return *insert_unique(v).first;
+		}
+
+		iterator find(const key_type& k)
+		{
+			size_type n = bkt_num_key(k);
+			node* first = buckets[n];
+			while(first != nullptr && !equals(get_key(first->val), k))
+				first = first->next;
+			return iterator(first, this);
+		}
+
+		const_iterator find(const key_type& k) const
+		{
+			size_type n = bkt_num_key(k);
+			node* first = buckets[n];
+			while(first != nullptr && !equals(get_key(first->val), k))
+				first = first->next;
+			return const_iterator(first, this);
+		}
+
+		size_type count(const key_type& k) const
+		{
+			size_type n = bkt_num_key(k);
+			size_type result = 0;
+			for(const node* cur = buckets[n]; cur != nullptr; cur = cur->next)
+				if(equals(get_key(cur->val), k))
+					++result;
+			return result;
+		}
+
+		pair<iterator, iterator> equal_range(const key_type& k)
+		{
+			size_type n = bkt_num_key(k);
+			for(node* first = buckets[n]; first != nullptr; first = first->next)
+			{
+				if(equals(get_key(first->val), k))
+				{
+					for(node* cur = first->next; cur != nullptr; cur = cur->next)
+						if(!equals(get_key(cur->val), k))
+							return pair<iterator, iterator>(iterator(first, this), iterator(cur, this));
+					for(size_type m = n + 1; m < buckets.size(); ++m)
+						if(buckets[m] != nullptr)
+							return pair<iterator, iterator>(iterator(first, this), iterator(buckets[m], this));
+					return pair<iterator, iterator>(iterator(first, this), end());
+				}
+			}
+			return pair<iterator, iterator>(end(), end());
+		}
+
+		pair<const_iterator, const_iterator> equal_range(const key_type& k) const
+		{
+			pair<iterator, iterator> p = const_cast<hashtable*>(this)->equal_range(k);
+			return pair<const_iterator, const_iterator>(p.first, p.second);
+		}
+
+		size_type erase(const key_type& k)
+		{
+			size_type n = bkt_num_key(k);
+			node* first = buckets[n];
+			size_type erased = 0;
+			if(first != nullptr)
+			{
+				node* cur = first;
+				node* next = cur->next;
+				while(next != nullptr)
+				{
+					if(equals(get_key(next->val), k))
+					{
+						cur->next = next->next;
+						delete_node(next);
+						next = cur->next;
+						++erased;
+						--num_elements;
+					}
+					else
+					{
+						cur = next;
+						next = cur->next;
+					}
+				}
+				if(equals(get_key(first->val), k))
+				{
+					buckets[n] = first->next;
+					delete_node(first);
+					++erased;
+					--num_elements;
+				}
+			}
+			return erased;
+		}
+
+		void erase(const_iterator it)
+		{
+			node* p = it.cur;
+			if(p == nullptr)
+				return;
+			size_type n = bkt_num(p->val);
+			node* cur = buckets[n];
+			if(cur == p)
+			{
+				buckets[n] = cur->next;
+				delete_node(cur);
+				--num_elements;
+			}
+			else
+			{
+				node* next = cur->next;
+				while(next != nullptr)
+				{
+					if(next == p)
+					{
+						cur->next = next->next;
+						delete_node(next);
+						--num_elements;
+						break;
+					}
+					cur = next;
+					next = cur->next;
+				}
+			}
+		}
+
+		void erase(const_iterator first, const_iterator last)
+		{
+			size_type f_bucket = first.cur != nullptr ? bkt_num(first.cur->val) : buckets.size();
+			size_type l_bucket = last.cur != nullptr ? bkt_num(last.cur->val) : buckets.size();
+			if(first.cur == last.cur)
+				return;
+			else if(f_bucket == l_bucket)
+				erase_bucket(f_bucket, first.cur, last.cur);
+			else
+			{
+				erase_bucket(f_bucket, first.cur, nullptr);
+				for(size_type n = f_bucket + 1; n < l_bucket; ++n)
+					erase_bucket(n, nullptr);
+				if(l_bucket != buckets.size())
+					erase_bucket(l_bucket, last.cur);
+			}
+		}
+
+		//grows the bucket vector so num_elements_hint elements fit at one per bucket; the
+		//nodes are relinked, never copied
+		void resize(size_type num_elements_hint)
+		{
+			size_type old_n = buckets.size();
+			if(num_elements_hint > old_n)
+			{
+				size_type n = next_size(num_elements_hint);
+				if(n > old_n)
+				{
+					vector<node*> tmp(n, nullptr);
+					for(size_type bucket = 0; bucket < old_n; ++bucket)
+					{
+						node* first = buckets[bucket];
+						while(first != nullptr)
+						{
+							size_type new_bucket = bkt_num(first->val, n);
+							buckets[bucket] = first->next;
+							first->next = tmp[new_bucket];
+							tmp[new_bucket] = first;
+							first = buckets[bucket];
+						}
+					}
+					buckets.swap(tmp);
+				}
+			}
+		}
+
+		void reserve(size_type n) { resize(n); }
+
+		//frees every node and keeps the bucket vector
+		void clear()
+		{
+			for(size_type i = 0; i < buckets.size(); ++i)
+			{
+				node* cur = buckets[i];
+				while(cur != nullptr)
+				{
+					node* next = cur->next;
+					delete_node(cur);
+					cur = next;
+				}
+				buckets[i] = nullptr;
+			}
+			num_elements = 0;
+		}
+	};
+
+	template<class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+	class incremental_hashtable;
+
+	template<class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc, class Reference, class Pointer>
+	struct incremental_hashtable_iterator
+	{
+		using iterator_category = forward_iterator_tag;
+		using value_type = Value;
+		using difference_type = ptrdiff_t;
+		using reference = Reference;
+		using pointer = Pointer;
+
+		using Self = incremental_hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc, Reference, Pointer>;
+		using iterator = incremental_hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc, Value&, Value*>;
+		using table = incremental_hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>;
+		using node = hashtable_node<Value>;
+
+		node* cur;
+		const table* ht;
+
+		incremental_hashtable_iterator() : cur(nullptr), ht(nullptr) {}
+		incremental_hashtable_iterator(node* n, const table* t) : cur(n), ht(t) {}
+		incremental_hashtable_iterator(const iterator& x) : cur(x.cur), ht(x.ht) {}
+
+		reference operator*() const { return cur->val; }
+		pointer operator->() const { return &(operator*()); }
+
+		Self& operator++()
+		{
+			cur = ht->next_node(cur);
+			return *this;
+		}
+
+		Self operator++(int)
+		{
+			Self tmp = *this;
+			++*this;
+			return tmp;
+		}
+
+		bool operator==(const Self& x) const { return cur == x.cur; }
+		bool operator!=(const Self& x) const { return cur != x.cur; }
+	};
+
+	//incremental_hashtable: a chaining table that never rehashes everything at once. When it
+	//outgrows its buckets the current bucket vector becomes the old table and a new one takes
+	//its place; each insert then moves rehash_step old buckets over, so no single insert relinks
+	//more than a few chains. A key lives in the old table while its old bucket is not moved yet
+	//and in the new one after, so a lookup checks at most two chains. The new bucket vector is
+	//itself allocated uninitialized at 3/4 load and zeroed prepare_step entries per insert, so
+	//the switch does not touch all of it at once either. Memory: the old table is drained
+	//within an eighth of the new bucket count in inserts, well before preparing starts, so at
+	//most two bucket vectors exist at once, about 3x the bucket count in pointers at the peak
+	//(hashtable's resize peaks the same way, just for one call). reserve and finish_rehash
+	//finish a running rehash on the spot. Inserts invalidate iteration order like hashtable's
+	//resize does, erase does not
+	template<class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc = default_alloc>
+	class incremental_hashtable
+	{
+	public:
+		using key_type = Key;
+		using value_type = Value;
+		using hasher = HashFcn;
+		using key_equal = EqualKey;
+		using size_type = size_t;
+		using difference_type = ptrdiff_t;
+		using pointer = value_type*;
+		using const_pointer = const value_type*;
+		using reference = value_type&;
+		using const_reference = const value_type&;
+
+		using iterator = incremental_hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc, Value&, Value*>;
+		using const_iterator = incremental_hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc, const Value&, const Value*>;
+
+		template<class, class, class, class, class, class, class, class>
+		friend struct incremental_hashtable_iterator;
+
+		//old buckets moved per insert while a rehash runs
+		static const size_type rehash_step = 4;
+		//entries of the next bucket vector zeroed per insert past 3/4 load
+		static const size_type prepare_step = 16;
+
+	private:
+		using node = hashtable_node<Value>;
+		using node_alloc = allocator<node, Alloc>;
+
+		hasher hash;
+		key_equal equals;
+		ExtractKey get_key;
+		vector<node*> buckets;
+		vector<node*> old_buckets;	//empty when no rehash is running
+		size_type migrated;			//old buckets below this index are moved already
+		vector<node*> next_buckets;	//the next table, zeroed up to prepared
+		size_type prepared;
+		size_type num_elements;
+
+		template<class... Args>
+		node* new_node(Args&&... args)
+		{
+			node* n = node_alloc::allocate();
+			grtw::construct(&n->val, grtw::forward<Args>(args)...);
+			n->next = nullptr;
+			return n;
+		}
+
+		void delete_node(node* n)
+		{
+			grtw::destroy(&n->val);
+			node_alloc::deallocate(n);
+		}
+
+		size_type next_size(size_type n) const { return stl_next_prime(n); }
+
+		void initialize_buckets(size_type n)
+		{
+			vector<node*> tmp(next_size(n), nullptr);
+			buckets.swap(tmp);
+			vector<node*>().swap(old_buckets);
+			vector<node*>().swap(next_buckets);
+			migrated = 0;
+			prepared = 0;
+			num_elements = 0;
+		}
+
+		//the head of the chain k belongs to, in whichever table holds it
+		node*& chain(const Key& k)
+		{
+			size_type h = hash(k);
+			if(!old_buckets.empty() && h % old_buckets.size() >= migrated)
+				return old_buckets[h % old_buckets.size()];
+			return buckets[h % buckets.size()];
+		}
+
+		node* chain(const Key& k) const { return const_cast<incremental_hashtable*>(this)->chain(k); }
+
+		static node* first_from(const vector<node*>& b, size_type n)
+		{
+			for(; n < b.size(); ++n)
+				if(b[n] != nullptr)
+					return b[n];
+			return nullptr;
+		}
+
+		//iteration walks the unmoved old buckets first, then the new table
+		node* next_node(const node* p) const
+		{
+			if(p->next != nullptr)
+				return p->next;
+			size_type h = hash(get_key(p->val));
+			if(!old_buckets.empty() && h % old_buckets.size() >= migrated)
+			{
+				node* n = first_from(old_buckets, h % old_buckets.size() + 1);
+				return n != nullptr ? n : first_from(buckets, 0);
+			}
+			return first_from(buckets, h % buckets.size() + 1);
+		}
+
+		//moves up to steps old buckets into the new table. Equal keys share an old bucket and
+		//sit next to each other in it, so relinking in order keeps them together
+		void migrate(size_type steps)
+		{
+			while(!old_buckets.empty() && steps-- > 0)
+			{
+				node* first = old_buckets[migrated];
+				while(first != nullptr)
+				{
+					node* next = first->next;
+					size_type n = hash(get_key(first->val)) % buckets.size();
+					first->next = buckets[n];
+					buckets[n] = first;
+					first = next;
+				}
+				old_buckets[migrated] = nullptr;
+				if(++migrated == old_buckets.size())
+				{
+					vector<node*>().swap(old_buckets);
+					migrated = 0;
+				}
+			}
+		}
+
+		//zeroes up to steps more entries of a next table of n buckets, allocating it first
+		void prepare(size_type n, size_type steps)
+		{
+			if(next_buckets.size() != n)
+			{
+				vector<node*>().swap(next_buckets);
+				next_buckets.resize_default_init(n);
+				prepared = 0;
+			}
+			for(; prepared < n && steps > 0; --steps)
+				next_buckets[prepared++] = nullptr;
+		}
+
+		//makes a table of n buckets current and the current one old; a running rehash is
+		//finished first
+		void start_rehash(size_type n)
+		{
+			finish_rehash();
+			prepare(n, n);
+			buckets.swap(next_buckets);
+			old_buckets.swap(next_buckets);
+			migrated = 0;
+			prepared = 0;
+		}
+
+		//one migration step, preparing the next table past 3/4 load, and a new table when
+		//num_elements_hint no longer fits. A switch happens at half load of the new table:
+		//the old table, half as many buckets, is drained after an eighth of the bucket count
+		//in inserts, and the quarter from 3/4 load to full zeroes 4x the bucket count, twice
+		//the next table's size
+		void grow(size_type num_elements_hint)
+		{
+			migrate(rehash_step);
+			size_type n = next_size(buckets.size() + 1);
+			if(n > buckets.size())
+			{
+				if(num_elements_hint > buckets.size() - buckets.size() / 4)
+					prepare(n, prepare_step);
+				if(num_elements_hint > buckets.size())
+					start_rehash(n);
+			}
+		}
+
+		iterator link_equal(node* tmp, node*& first)
+		{
+			for(node* cur = first; cur != nullptr; cur = cur->next)
+			{
+				if(equals(get_key(cur->val), get_key(tmp->val)))
+				{
+					tmp->next = cur->next;
+					cur->next = tmp;
+					++num_elements;
+					return iterator(tmp, this);
+				}
+			}
+			tmp->next = first;
+			first = tmp;
+			++num_elements;
+			return iterator(tmp, this);
+		}
+
+		//the copy gets a single table; other's iteration order keeps equal keys together
+		void copy_from(const incremental_hashtable& other)
+		{
+			vector<node*> tmp(other.buckets.size(), nullptr);
+			buckets.swap(tmp);
+			for(const_iterator it = other.begin(); it != other.end(); ++it)
+			{
+				node* copy = new_node(*it);
+				size_type n = hash(get_key(copy->val)) % buckets.size();
+				copy->next = buckets[n];
+				buckets[n] = copy;
+			}
+			num_elements = other.num_elements;
+		}
+
+	public:
+		explicit incremental_hashtable(size_type n = 100, const hasher& hf = hasher(), const key_equal& eql = key_equal())
+			: hash(hf), equals(eql), get_key(), migrated(0), prepared(0), num_elements(0)
+		{
+			initialize_buckets(n);
+		}
+
+		incremental_hashtable(const incremental_hashtable& other)
+			: hash(other.hash), equals(other.equals), get_key(other.get_key), migrated(0), prepared(0), num_elements(0)
+		{
+			copy_from(other);
+		}
+
+		incremental_hashtable(incremental_hashtable&& other) : hash(other.hash), equals(other.equals), get_key(other.get_key),
+			buckets(grtw::move(other.buckets)), old_buckets(grtw::move(other.old_buckets)), migrated(other.migrated),
+			next_buckets(grtw::move(other.next_buckets)), prepared(other.prepared), num_elements(other.num_elements)
+		{
+			other.initialize_buckets(0);
+		}
+
+		incremental_hashtable& operator=(const incremental_hashtable& other)
+		{
+			if(this != &other)
+			{
+				clear();
+				hash = other.hash;
+				equals = other.equals;
+				get_key = other.get_key;
+				copy_from(other);
+			}
+			return *this;
+		}
+
+		incremental_hashtable& operator=(incremental_hashtable&& other)
+		{
+			if(this != &other)
+			{
+				clear();
+				swap(other);
+			}
+			return *this;
+		}
+
+		~incremental_hashtable() { clear(); }
+
+		void swap(incremental_hashtable& other) noexcept
+		{
+			grtw::swap(hash, other.hash);
+			grtw::swap(equals, other.equals);
+			grtw::swap(get_key, other.get_key);
+			buckets.swap(other.buckets);
+			old_buckets.swap(other.old_buckets);
+			grtw::swap(migrated, other.migrated);
+			next_buckets.swap(other.next_buckets);
+			grtw::swap(prepared, other.prepared);
+			grtw::swap(num_elements, other.num_elements);
+		}
+
+		hasher hash_funct() const { return hash; }
+		key_equal key_eq() const { return equals; }
+
+		size_type size() const { return num_elements; }
+		size_type max_size() const { return size_type(-1); }
+		bool empty() const { return num_elements == 0; }
+
+		iterator begin()
+		{
+			node* n = first_from(old_buckets, migrated);
+			return iterator(n != nullptr ? n : first_from(buckets, 0), this);
+		}
+
+		const_iterator begin() const
+		{
+			node* n = first_from(old_buckets, migrated);
+			return const_iterator(n != nullptr ? n : first_from(buckets, 0), this);
+		}
+
+		iterator end() { return iterator(nullptr, this); }
+		const_iterator end() const { return const_iterator(nullptr, this); }
+
+		//the bucket count of the table inserts go to
+		size_type bucket_count() const { return buckets.size(); }
+		size_type max_bucket_count() const { return stl_prime_list[stl_num_primes - 1]; }
+
+		bool rehashing() const { return !old_buckets.empty(); }
+
+		//moves every remaining old bucket now
+		void finish_rehash() { migrate(old_buckets.size()); }
+
+		pair<iterator, bool> insert_unique(const value_type& v) { return emplace_unique_key(get_key(v), v); }
+		pair<iterator, bool> insert_unique(value_type&& v) { return emplace_unique_key(get_key(v), grtw::move(v)); }
+		iterator insert_equal(const value_type& v) { return emplace_equal(v); }
+		iterator insert_equal(value_type&& v) { return emplace_equal(grtw::move(v)); }
+
+		template<class InputIterator>
+		void insert_unique(InputIterator first, InputIterator last)
+		{
+			for(; first != last; ++first)
+				insert_unique(*first);
+		}
+
+		template<class InputIterator>
+		void insert_equal(InputIterator first, InputIterator last)
+		{
+			for(; first != last; ++first)
+				insert_equal(*first);
+		}
+
+		//builds the node from args only when k is not in the table yet
+		template<class... Args>
+		pair<iterator, bool> emplace_unique_key(const Key& k, Args&&... args)
+		{
+			grow(num_elements + 1);
+			node*& first = chain(k);
+			for(node* cur = first; cur != nullptr; cur = cur->next)
+				if(equals(get_key(cur->val), k))
+					return pair<iterator, bool>(iterator(cur, this), false);
+			node* tmp = new_node(grtw::forward<Args>(args)...);
+			tmp->next = first;
+			first = tmp;
+			++num_elements;
+			return pair<iterator, bool>(iterator(tmp, this), true);
+		}
+
+		template<class... Args>
+		pair<iterator, bool> emplace_unique(Args&&... args)
+		{
+			node* tmp = new_node(grtw::forward<Args>(args)...);
+			grow(num_elements + 1);
+			node*& first = chain(get_key(tmp->val));
+			for(node* cur = first; cur != nullptr; cur = cur->next)
+			{
+				if(equals(get_key(cur->val), get_key(tmp->val)))
+				{
+					delete_node(tmp);
+					return pair<iterator, bool>(iterator(cur, this), false);
+				}
+			}
+			tmp->next = first;
+			first = tmp;
+			++num_elements;
+			return pair<iterator, bool>(iterator(tmp, this), true);
+		}
+
+		template<class... Args>
+		iterator emplace_equal(Args&&... args)
+		{
+			node* tmp = new_node(grtw::forward<Args>(args)...);
+			grow(num_elements + 1);
+			return link_equal(tmp, chain(get_key(tmp->val)));
+		}
+
+		reference find_or_insert(const value_type& v)
+		{
+			return *insert_unique(v).first;
+		}
+
+		iterator find(const key_type& k)
+		{
+			node* first = chain(k);
+			while(first != nullptr && !equals(get_key(first->val), k))
+				first = first->next;
+			return iterator(first, this);
+		}
+
+		const_iterator find(const key_type& k) const
+		{
+			node* first = chain(k);
+			while(first != nullptr && !equals(get_key(first->val), k))
+				first = first->next;
+			return const_iterator(first, this);
+		}
+
+		size_type count(const key_type& k) const
+		{
+			size_type result = 0;
+			for(const node* cur = chain(k); cur != nullptr; cur = cur->next)
+				if(equals(get_key(cur->val), k))
+					++result;
+			return result;
+		}
+
+		pair<iterator, iterator> equal_range(const key_type& k)
+		{
+			for(node* first = chain(k); first != nullptr; first = first->next)
+			{
+				if(equals(get_key(first->val), k))
+				{
+					node* last = first;
+					while(last->next != nullptr && equals(get_key(last->next->val), k))
+						last = last->next;
+					return pair<iterator, iterator>(iterator(first, this), iterator(next_node(last), this));
+				}
+			}
+			return pair<iterator, iterator>(end(), end());
+		}
+
+		pair<const_iterator, const_iterator> equal_range(const key_type& k) const
+		{
+			pair<iterator, iterator> p = const_cast<incremental_hashtable*>(this)->equal_range(k);
+			return pair<const_iterator, const_iterator>(p.first, p.second);
+		}
+
+		//the run of equal keys is found before anything is freed, k may live in one of them
+		size_type erase(const key_type& k)
+		{
+			node** link = &chain(k);
+			while(*link != nullptr && !equals(get_key((*link)->val), k))
+				link = &(*link)->next;
+			if(*link == nullptr)
+				return 0;
+			node* last = (*link)->next;
+			while(last != nullptr && equals(get_key(last->val), k))
+				last = last->next;
+			size_type erased = 0;
+			while(*link != last)
+			{
+				node* cur = *link;
+				*link = cur->next;
+				delete_node(cur);
+				++erased;
+			}
+			num_elements -= erased;
+			return erased;
+		}
+
+		void erase(const_iterator it)
+		{
+			node* p = it.cur;
+			if(p == nullptr)
+				return;
+			node** link = &chain(get_key(p->val));
+			while(*link != p)
+				link = &(*link)->next;
+			*link = p->next;
+			delete_node(p);
+			--num_elements;
+		}
+
+		//finishes a running rehash, then grows to fit num_elements_hint in one go
+		void resize(size_type num_elements_hint)
+		{
+			finish_rehash();
+			if(num_elements_hint > buckets.size())
+			{
+				size_type n = next_size(num_elements_hint);
+				if(n > buckets.size())
+				{
+					start_rehash(n);
+					finish_rehash();
+				}
+			}
+		}
+
+		void reserve(size_type n) { resize(n); }
+
+		//frees every node, keeps the new bucket vector and drops the old one
+		void clear()
+		{
+			for(size_type i = migrated; i < old_buckets.size(); ++i)
+			{
+				node* cur = old_buckets[i];
+				while(cur != nullptr)
+				{
+					node* next = cur->next;
+					delete_node(cur);
+					cur = next;
+				}
+			}
+			vector<node*>().swap(old_buckets);
+			migrated = 0;
+			for(size_type i = 0; i < buckets.size(); ++i)
+			{
+				node* cur = buckets[i];
+				while(cur != nullptr)
+				{
+					node* next = cur->next;
+					delete_node(cur);
+					cur = next;
+				}
+				buckets[i] = nullptr;
+			}
+			num_elements = 0;
+		}
+	};
+
+	template<class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+	const size_t incremental_hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::rehash_step;
 
+	template<class Value, class Key, class HashFcn, class ExtractKey, class EqualKey, class Alloc>
+	const size_t incremental_hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>::prepare_step;
 }
 
-#endif
\ No newline at end of file
+#endif
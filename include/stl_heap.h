@@ -2,26 +2,27 @@
 #define GRTW_STL_HEAP_H
 
 #include"stl_iterator.h"
+#include"stl_utility.h"
 
 namespace grtw
 {
 	template<class RandomAccessIterator, class T, class Distance>
 	void _push_heap(RandomAccessIterator vfirst, Distance holeIndex, Distance topIndex, T value)
 	{
-		Distance parent = (len - 1)/2;
+		Distance parent = (holeIndex - 1)/2;
 		while(holeIndex > topIndex && *(vfirst + parent) < value)
 		{
-			*(vfirst + holeIndex) = *(vfirst + parent);
+			*(vfirst + holeIndex) = grtw::move(*(vfirst + parent));
 			holeIndex = parent;
 			parent = (holeIndex - 1)/2;
 		}
-		*(vfirst + holeIndex) = value;
+		*(vfirst + holeIndex) = grtw::move(value);
 	}
 
 	template<class RandomAccessIterator, class T, class Distance>
 	inline void push_heap_aux(RandomAccessIterator vfirst, RandomAccessIterator vlast, T*, Distance*)
 	{
-		_push_heap(vfirst, Distance((vlast - vfirst) - 1), Distance(0), T(*(vlast - 1)));
+		_push_heap(vfirst, Distance((vlast - vfirst) - 1), Distance(0), T(grtw::move(*(vlast - 1))));
 	}
 
 	template<class RandomAccessIterator>
@@ -33,20 +34,20 @@ namespace grtw
 	template<class RandomAccessIterator, class T, class Distance, class Compare>
 	void _push_heap(RandomAccessIterator vfirst, Distance holeIndex, Distance topIndex, T value, Compare comp)
 	{
-		Distance parent = (len - 1)/2;
+		Distance parent = (holeIndex - 1)/2;
 		while(holeIndex > topIndex && comp(*(vfirst + parent), value))
 		{
-			*(vfirst + holeIndex) = *(vfirst + parent);
+			*(vfirst + holeIndex) = grtw::move(*(vfirst + parent));
 			holeIndex = parent;
 			parent = (holeIndex - 1)/2;
 		}
-		*(vfirst + holeIndex) = value;
+		*(vfirst + holeIndex) = grtw::move(value);
 	}
 
 	template<class RandomAccessIterator, class T, class Distance, class Compare>
 	inline void push_heap_aux(RandomAccessIterator vfirst, RandomAccessIterator vlast, T*, Distance*, Compare comp)
 	{
-		_push_heap(vfirst, Distance((vlast - vfirst) - 1), Distance(0), T(*(vlast - 1)), comp);
+		_push_heap(vfirst, Distance((vlast - vfirst) - 1), Distance(0), T(grtw::move(*(vlast - 1))), comp);
 	}
 
 	template<class RandomAccessIterator, class Compare>
@@ -66,28 +67,29 @@ namespace grtw
 			{
 				--second_child;
 			}
+			*(vfirst + holeIndex) = grtw::move(*(vfirst + second_child));
 			holeIndex = second_child;
 			second_child = second_child * 2 + 2;
 		}
 		if(second_child == len)
 		{
-			*(vfirst + holeIndex) = *(vfirst + second_child - 1);
+			*(vfirst + holeIndex) = grtw::move(*(vfirst + second_child - 1));
 			holeIndex = second_child - 1;
 		}
-		_push_heap(vfirst, holeIndex, topIndex, value);
+		_push_heap(vfirst, holeIndex, topIndex, grtw::move(value));
 	}
 
 	template<class RandomAccessIterator, class T, class Distance>
 	inline void _pop_heap(RandomAccessIterator vfirst, RandomAccessIterator vlast, RandomAccessIterator result, T value, Distance*)
 	{
-		*result = * vfirst;
-		adjust_heap(vfirst, Distance(0), Distance(vlast - vfirst), value);
+		*result = grtw::move(*vfirst);
+		adjust_heap(vfirst, Distance(0), Distance(vlast - vfirst), grtw::move(value));
 	}
 
 	template<class RandomAccessIterator, class T>
 	inline void pop_heap_aux(RandomAccessIterator vfirst, RandomAccessIterator vlast, T*)
 	{
-		_pop_heap(vfirst, vlast - 1, vlast - 1, T(*(vlast - 1)), distance_type(vfirst));
+		_pop_heap(vfirst, vlast - 1, vlast - 1, T(grtw::move(*(vlast - 1))), distance_type(vfirst));
 	}
 
 	template<class RandomAccessIterator>
@@ -107,28 +109,29 @@ namespace grtw
 			{
 				--second_child;
 			}
+			*(vfirst + holeIndex) = grtw::move(*(vfirst + second_child));
 			holeIndex = second_child;
 			second_child = second_child * 2 + 2;
 		}
 		if(second_child == len)
 		{
-			*(vfirst + holeIndex) = *(vfirst + second_child - 1);
+			*(vfirst + holeIndex) = grtw::move(*(vfirst + second_child - 1));
 			holeIndex = second_child - 1;
 		}
-		_push_heap(vfirst, holeIndex, topIndex, value, comp);
+		_push_heap(vfirst, holeIndex, topIndex, grtw::move(value), comp);
 	}
 
 	template<class RandomAccessIterator, class T, class Distance, class Compare>
 	inline void _pop_heap(RandomAccessIterator vfirst, RandomAccessIterator vlast, RandomAccessIterator result, T value, Distance*, Compare comp)
 	{
-		*result = * vfirst;
-		adjust_heap(vfirst, Distance(0), Distance(vlast - vfirst), value, comp);
+		*result = grtw::move(*vfirst);
+		adjust_heap(vfirst, Distance(0), Distance(vlast - vfirst), grtw::move(value), comp);
 	}
 
 	template<class RandomAccessIterator, class T, class Compare>
 	inline void pop_heap_aux(RandomAccessIterator vfirst, RandomAccessIterator vlast, T*, Compare comp)
 	{
-		_pop_heap(vfirst, vlast - 1, vlast - 1, T(*(vlast - 1)), distance_type(vfirst), comp);
+		_pop_heap(vfirst, vlast - 1, vlast - 1, T(grtw::move(*(vlast - 1))), distance_type(vfirst), comp);
 	}
 
 	template<class RandomAccessIterator, class Compare>
@@ -146,7 +149,7 @@ namespace grtw
 			Distance holeIndex = len/2 - 1;
 			while(1)
 			{
-				adjust_heap(vfirst, holeIndex, len, T(*(vfirst + holeIndex)));
+				adjust_heap(vfirst, holeIndex, len, T(grtw::move(*(vfirst + holeIndex))));
 				if(holeIndex == 0)
 					return;
 				--holeIndex;
@@ -169,7 +172,7 @@ namespace grtw
 			Distance holeIndex = len/2 - 1;
 			while(1)
 			{
-				adjust_heap(vfirst, holeIndex, len, T(*(vfirst + holeIndex)), comp);
+				adjust_heap(vfirst, holeIndex, len, T(grtw::move(*(vfirst + holeIndex))), comp);
 				if(holeIndex == 0)
 					return;
 				--holeIndex;
@@ -0,0 +1,195 @@
+#ifndef GRTW_STL_HUGEPAGE_H
+#define GRTW_STL_HUGEPAGE_H
+
+#include<cstddef>
+#include<cstdint>
+#include<cstring>
+#include<new>
+#include<mutex>
+#include<sys/mman.h>
+#include"stl_alloc.h"
+
+namespace grtw
+{
+	//hugepage_alloc: requests of Threshold bytes and up get whole 2MB pages, mapped 2MB-aligned
+	//and advised for transparent huge pages so large random-access data takes fewer TLB misses;
+	//freed regions are cached for requests of the same size, smaller requests go to SmallAlloc
+	template<size_t Threshold = (1 << 21), class SmallAlloc = default_alloc>
+	class hugepage_alloc
+	{
+	public:
+		static const size_t page_size = 1 << 21;
+		static const size_t alignment = SmallAlloc::alignment;
+
+		static void* allocate(size_t);
+		static void deallocate(void*, size_t);
+		static void* reallocate(void*, size_t, size_t);
+
+		static void set_cache_limit(size_t);
+		static size_t release_cache();
+
+	private:
+		struct region
+		{
+			region* next;
+			size_t size;
+		};
+
+		static size_t region_size(size_t n) { return (n + page_size - 1) & ~(page_size - 1); }
+		static void* map_region(size_t);
+		static void advise(void* p, size_t size);
+
+		static std::mutex cache_mutex;
+		static region* cache;
+		static size_t cached_bytes;
+		static size_t cache_limit;
+	};
+
+	template<size_t Threshold, class SmallAlloc>
+	std::mutex hugepage_alloc<Threshold, SmallAlloc>::cache_mutex;
+
+	template<size_t Threshold, class SmallAlloc>
+	typename hugepage_alloc<Threshold, SmallAlloc>::region* hugepage_alloc<Threshold, SmallAlloc>::cache = nullptr;
+
+	template<size_t Threshold, class SmallAlloc>
+	size_t hugepage_alloc<Threshold, SmallAlloc>::cached_bytes = 0;
+
+	template<size_t Threshold, class SmallAlloc>
+	size_t hugepage_alloc<Threshold, SmallAlloc>::cache_limit = size_t(32) << 21;
+
+	template<size_t Threshold, class SmallAlloc>
+	void* hugepage_alloc<Threshold, SmallAlloc>::allocate(size_t n)
+	{
+		if(n < Threshold)
+			return SmallAlloc::allocate(n);
+		size_t size = region_size(n);
+		{
+			std::lock_guard<std::mutex> guard(cache_mutex);
+			for(region** r = &cache; *r != nullptr; r = &(*r)->next)
+			{
+				if((*r)->size == size)
+				{
+					region* res = *r;
+					*r = res->next;
+					cached_bytes -= size;
+					return (void*)res;
+				}
+			}
+		}
+		return map_region(size);
+	}
+
+	template<size_t Threshold, class SmallAlloc>
+	void hugepage_alloc<Threshold, SmallAlloc>::deallocate(void* p, size_t n)
+	{
+		if(n < Threshold)
+		{
+			SmallAlloc::deallocate(p, n);
+			return;
+		}
+		size_t size = region_size(n);
+		{
+			std::lock_guard<std::mutex> guard(cache_mutex);
+			if(cached_bytes + size <= cache_limit)
+			{
+				region* r = static_cast<region*>(p);
+				r->size = size;
+				r->next = cache;
+				cache = r;
+				cached_bytes += size;
+				return;
+			}
+		}
+		munmap(p, size);
+	}
+
+	template<size_t Threshold, class SmallAlloc>
+	void* hugepage_alloc<Threshold, SmallAlloc>::reallocate(void* p, size_t old_size, size_t new_size)
+	{
+		if(p == nullptr)
+			return allocate(new_size);
+		if(old_size < Threshold && new_size < Threshold)
+			return SmallAlloc::reallocate(p, old_size, new_size);
+		if(old_size >= Threshold && new_size >= Threshold)
+		{
+			size_t old_region = region_size(old_size);
+			size_t new_region = region_size(new_size);
+			if(new_region == old_region)
+				return p;
+			if(new_region < old_region)
+			{
+				munmap((char*)p + new_region, old_region - new_region);
+				return p;
+			}
+#ifdef __linux__
+			//grow in place when the pages behind the region are free
+			if(mremap(p, old_region, new_region, 0) != MAP_FAILED)
+			{
+				advise((char*)p + old_region, new_region - old_region);
+				return p;
+			}
+#endif
+		}
+		void* res = allocate(new_size);
+		memcpy(res, p, old_size < new_size ? old_size : new_size);
+		deallocate(p, old_size);
+		return res;
+	}
+
+	template<size_t Threshold, class SmallAlloc>
+	void hugepage_alloc<Threshold, SmallAlloc>::set_cache_limit(size_t bytes)
+	{
+		std::lock_guard<std::mutex> guard(cache_mutex);
+		cache_limit = bytes;
+	}
+
+	//unmap every cached region; returns the number of bytes given back
+	template<size_t Threshold, class SmallAlloc>
+	size_t hugepage_alloc<Threshold, SmallAlloc>::release_cache()
+	{
+		region* r;
+		size_t released;
+		{
+			std::lock_guard<std::mutex> guard(cache_mutex);
+			r = cache;
+			released = cached_bytes;
+			cache = nullptr;
+			cached_bytes = 0;
+		}
+		while(r != nullptr)
+		{
+			region* next = r->next;
+			munmap(r, r->size);
+			r = next;
+		}
+		return released;
+	}
+
+	//map one page more than needed and unmap the misaligned head and tail
+	template<size_t Threshold, class SmallAlloc>
+	void* hugepage_alloc<Threshold, SmallAlloc>::map_region(size_t size)
+	{
+		void* p = mmap(nullptr, size + page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(p == MAP_FAILED)
+			throw std::bad_alloc();
+		uintptr_t start = (uintptr_t)p;
+		uintptr_t aligned = (start + page_size - 1) & ~(uintptr_t)(page_size - 1);
+		if(aligned != start)
+			munmap(p, aligned - start);
+		size_t tail = page_size - (aligned - start);
+		if(tail != 0)
+			munmap((void*)(aligned + size), tail);
+		advise((void*)aligned, size);
+		return (void*)aligned;
+	}
+
+	template<size_t Threshold, class SmallAlloc>
+	void hugepage_alloc<Threshold, SmallAlloc>::advise(void* p, size_t size)
+	{
+#ifdef MADV_HUGEPAGE
+		madvise(p, size, MADV_HUGEPAGE);
+#endif
+	}
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define GRTW_STL_ITERATOR_BASE_H
 
 #include<cstddef>
+#include<iterator>
 
 namespace grtw
 {
@@ -70,10 +71,56 @@ namespace grtw
 		using reference = Reference;
 	};
 
+	//std iterators (std containers, istream_iterator) carry std tags; they are mapped onto the
+	//grtw ones so those iterators reach the same dispatch as grtw's own
+	template<class Tag>
+	struct Iterator_tag
+	{
+		using Category = Tag;
+	};
+
+	template<>
+	struct Iterator_tag<std::input_iterator_tag>
+	{
+		using Category = input_iterator_tag;
+	};
+
+	template<>
+	struct Iterator_tag<std::output_iterator_tag>
+	{
+		using Category = output_iterator_tag;
+	};
+
+	template<>
+	struct Iterator_tag<std::forward_iterator_tag>
+	{
+		using Category = forward_iterator_tag;
+	};
+
+	template<>
+	struct Iterator_tag<std::bidirectional_iterator_tag>
+	{
+		using Category = bidirectional_iterator_tag;
+	};
+
+	template<>
+	struct Iterator_tag<std::random_access_iterator_tag>
+	{
+		using Category = random_access_iterator_tag;
+	};
+
+#if __cplusplus > 201703L
+	template<>
+	struct Iterator_tag<std::contiguous_iterator_tag>
+	{
+		using Category = random_access_iterator_tag;
+	};
+#endif
+
 	template<class Iterator>
 	struct iterator_traits
 	{
-		using iterator_category = typename Iterator::iterator_category;
+		using iterator_category = typename Iterator_tag<typename Iterator::iterator_category>::Category;
 		using value_type = typename Iterator::value_type;
 		using difference_type = typename Iterator::difference_type;
 		using pointer = typename Iterator::pointer;
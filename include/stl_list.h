@@ -4,6 +4,9 @@
 #include"stl_construct.h"
 #include"stl_iterator.h"
 #include"stl_allocator.h"
+#include"stl_allocator_traits.h"
+#include"stl_utility.h"
+#include"stl_algorithms.h"
 
 namespace grtw
 {
@@ -13,8 +16,6 @@ namespace grtw
 		T data;
 		ListNode* prev;
 		ListNode* next;
-		ListNode() : data(T()), prev(nullptr), next(nullptr) {}
-		~ListNode() { destroy(&data); }
 	};
 
 	template<class T, class Reference, class Pointer>
@@ -66,8 +67,8 @@ namespace grtw
 			return tmp;
 		}
 
-		bool operator==(const self& x) const { return node = x.node; }
-		bool operator!=(const self& x) const { return node = x.node; }
+		bool operator==(const self& x) const { return node == x.node; }
+		bool operator!=(const self& x) const { return node != x.node; }
 	};
 
 	template<class T, class Alloc = allocator<ListNode<T> > >
@@ -86,56 +87,77 @@ namespace grtw
 		using const_iterator = List_iterator<value_type, const_reference, const_pointer>;
 		using const_reverse_iterator = Reverse_iterator<const_iterator>;
 		using reverse_iterator = Reverse_iterator<iterator>;
+		using allocator_type = Alloc;
+
 	private:
-		ListNode<value_type>* head;
+		using alloc_traits = allocator_traits<Alloc>;
+
+		//the allocator is a base of the storage, so a stateless one takes no space
+		struct storage : public Alloc
+		{
+			ListNode<value_type>* head;
+
+			storage(const Alloc& a) : Alloc(a), head(nullptr) {}
+		};
+
+		storage impl;
+
+		ListNode<value_type>* get_node() { return alloc_traits::allocate(impl, 1); }
+		void put_node(ListNode<value_type>* p) { alloc_traits::deallocate(impl, p, 1); }
+
+		void empty_initialize()
+		{
+			impl.head = get_node();
+			impl.head->next = impl.head;
+			impl.head->prev = impl.head;
+		}
+
 	public:
-		list()
+		list() : impl(Alloc())
 		{
-			head = Alloc::allocator(1);
-			head->next = head;
-			head->prev = head;
+			empty_initialize();
 		}
 
-		explicit list(size_type n)
+		explicit list(const Alloc& a) : impl(a)
 		{
-			head = Alloc::allocator(1);
-			head->next = head;
-			head->prev = head;
+			empty_initialize();
+		}
+
+		explicit list(size_type n, const Alloc& a = Alloc()) : impl(a)
+		{
+			empty_initialize();
 			insert(begin(), n, value_type());
 		}
 
-		list(size_type, const value_type& v)
+		list(size_type n, const value_type& v, const Alloc& a = Alloc()) : impl(a)
 		{
-			head = Alloc::allocator(1);
-			head->next = head;
-			head->prev = head;
+			empty_initialize();
 			insert(begin(), n, v);
 		}
 
-		list(const value_type* vfirst, const value_type* vlast)
+		list(const value_type* vfirst, const value_type* vlast, const Alloc& a = Alloc()) : impl(a)
 		{
-			head = Alloc::allocator(1);
-			head->next = head;
-			head->prev = head;
+			empty_initialize();
 			insert(begin(), vfirst, vlast);
 		}
 
-		list(const_iterator vfirst, const_iterator vlast)
+		list(const_iterator vfirst, const_iterator vlast, const Alloc& a = Alloc()) : impl(a)
 		{
-			head = Alloc::allocator(1);
-			head->next = head;
-			head->prev = head;
+			empty_initialize();
 			insert(begin(), vfirst, vlast);
 		}
 
-		list(const list<value_type, Alloc>& other)
+		list(const list<value_type, Alloc>& other) : impl(alloc_traits::select_on_container_copy_construction(other.impl))
 		{
-			head = Alloc::allocator(1);
-			head->next = head;
-			head->prev = head;
+			empty_initialize();
 			insert(begin(), other.begin(), other.end());
 		}
 
+		list(list<value_type, Alloc>&& other) : impl(other.impl)
+		{
+			other.empty_initialize();
+		}
+
 		list<value_type, Alloc>& operator=(const list<value_type, Alloc>& other)
 		{
 			if(this != &other)
@@ -154,26 +176,40 @@ namespace grtw
 			return *this;
 		}
 
+		list<value_type, Alloc>& operator=(list<value_type, Alloc>&& other)
+		{
+			if(this != &other)
+			{
+				clear();
+				swap(other);
+			}
+			return *this;
+		}
+
 		~list()
 		{
 			clear();
-			Alloc::deallocate(head);
+			put_node(impl.head);
 		}
+
+		allocator_type get_allocator() const { return impl; }
+
+		void swap(list<value_type, Alloc>& other) noexcept { grtw::swap(impl, other.impl); }
 		
-		iterator begin() { return head->next; }
-		const_iterator begin() const { return head->next; }
-		iterator end() { return head; }
-		const_iterator end() const { return head; }
+		iterator begin() { return impl.head->next; }
+		const_iterator begin() const { return impl.head->next; }
+		iterator end() { return impl.head; }
+		const_iterator end() const { return impl.head; }
 		reverse_iterator rbegin() { return reverse_iterator(end()); }
 		const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
 		reverse_iterator rend() { return reverse_iterator(begin()); }
 		const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
 
-		bool empty() const { return head->next == head; }
+		bool empty() const { return impl.head->next == impl.head; }
 		size_type size() const
 		{
 			size_type result = 0;
-			distance(begin(), end(), result);
+			grtw::distance(begin(), end(), result);
 			return result;
 		}
 
@@ -182,10 +218,14 @@ namespace grtw
 		reference back() { return *(--end()); }
 		const_reference back() const { return *(--end()); }
 
-		iterator insert(iterator position, const value_type& v)
+		iterator insert(iterator position, const value_type& v) { return emplace(position, v); }
+		iterator insert(iterator position, value_type&& v) { return emplace(position, grtw::move(v)); }
+
+		template<class... Args>
+		iterator emplace(iterator position, Args&&... args)
 		{
-			ListNode<value_type>* tmp = Alloc::allocator(1);
-			construct(&(tmp->data), v);
+			ListNode<value_type>* tmp = get_node();
+			grtw::construct(&(tmp->data), grtw::forward<Args>(args)...);
 			tmp->next = position.node;
 			tmp->prev = position.node->prev;
 			position.node->prev->next = tmp;
@@ -212,7 +252,14 @@ namespace grtw
 		}
 
 		void push_front(const value_type& x) { insert(begin(), x); }
-		void push_back(const value_type&) { insert(end(), x); }
+		void push_back(const value_type& x) { insert(end(), x); }
+		void push_front(value_type&& x) { insert(begin(), grtw::move(x)); }
+		void push_back(value_type&& x) { insert(end(), grtw::move(x)); }
+
+		template<class... Args>
+		void emplace_front(Args&&... args) { emplace(begin(), grtw::forward<Args>(args)...); }
+		template<class... Args>
+		void emplace_back(Args&&... args) { emplace(end(), grtw::forward<Args>(args)...); }
 
 		iterator erase(iterator position)
 		{
@@ -221,8 +268,8 @@ namespace grtw
 			ListNode<value_type>* n = position.node;
 			prev_node->next = next_node;
 			next_node->prev = prev_node;
-			destroy(n);
-			Alloc::deallocate(n);
+			grtw::destroy(&(n->data));
+			put_node(n);
 			return next_node;
 		}
 
@@ -235,16 +282,16 @@ namespace grtw
 
 		void clear()
 		{
-			ListNode<value_type>* current = head->next;
-			while(current != head)
+			ListNode<value_type>* current = impl.head->next;
+			while(current != impl.head)
 			{
 				ListNode<value_type>* tmp = current;
 				current = current->next;
-				destroy(tmp);
-				Alloc::deallocate(tmp);
+				grtw::destroy(&(tmp->data));
+				put_node(tmp);
 			}
-			head->next = head;
-			head->prev = head;
+			impl.head->next = impl.head;
+			impl.head->prev = impl.head;
 		}
 
 		void resize(size_type new_size, const value_type& v)
@@ -278,7 +325,7 @@ namespace grtw
 				++i1;
 				++i2;
 			}
-			return it == end1 && i2 == end2;
+			return i1 == end1 && i2 == end2;
 		}
 
 		bool operator!=(const list<value_type, Alloc>& other)
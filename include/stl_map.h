@@ -5,6 +5,7 @@
 #include"stl_allocator.h"
 #include"stl_rbtree.h"
 #include"stl_pair.h"
+#include"stl_utility.h"
 
 namespace grtw
 {
@@ -26,24 +27,36 @@ namespace grtw
 		using const_reverse_iterator = typename repo_type::const_reverse_iterator;
 		using size_type = typename repo_type::size_type;
 		using difference_type = typename repo_type::difference_type;
+		using allocator_type = typename repo_type::allocator_type;
 
 	private:
 		repo_type repository;
 
 	public:
 		map() : repository(Compare()) {}
-		explicit map(const Compare& comp) : repository(comp) {}
+		explicit map(const Compare& comp, const Alloc& a = Alloc()) : repository(comp, a) {}
 		map(const value_type* vfirst, const value_type* vlast) : repository(Compare()) { repository.insert_unique(vfirst, vlast); }
 		map(const value_type* vfirst, const value_type* vlast, const Compare& comp) : repository(comp) { repository.insert_unique(vfirst, vlast); }
 		map(const_iterator vfirst, const_iterator vlast) : repository(Compare()) { repository.insert_unique(vfirst, vlast); }
 		map(const_iterator vfirst, const_iterator vlast, const Compare& comp) : repository(comp) { repository.insert_unique(vfirst, vlast); }
 		map(const map<Key, Value, Compare, Alloc>& other) : repository(other.repository) {}
+		map(map<Key, Value, Compare, Alloc>&& other) : repository(grtw::move(other.repository)) {}
 		map<Key, Value, Compare, Alloc>& operator=(const map<Key, Value, Compare, Alloc>& other)
 		{
 			repository = other.repository;
 			return *this;
 		}
 
+		map<Key, Value, Compare, Alloc>& operator=(map<Key, Value, Compare, Alloc>&& other)
+		{
+			repository = grtw::move(other.repository);
+			return *this;
+		}
+
+		allocator_type get_allocator() const { return repository.get_allocator(); }
+
+		void swap(map<Key, Value, Compare, Alloc>& other) noexcept { repository.swap(other.repository); }
+
 		iterator begin() { return repository.begin(); }
 		const_iterator begin() const { return repository.begin(); }
 		iterator end() { return repository.end(); }
@@ -55,15 +68,35 @@ namespace grtw
 		bool empty() { return repository.empty(); }
 		size_type size() { return repository.size(); }
 
-		Value& operator[](const Key& k)
+		Value& operator[](const Key& k) { return try_emplace(k).first->second; }
+		Value& operator[](Key&& k) { return try_emplace(grtw::move(k)).first->second; }
+
+		pair<iterator, bool> insert(const value_type& x) { return repository.insert_unique(x); }
+		pair<iterator, bool> insert(value_type&& x) { return repository.insert_unique(grtw::move(x)); }
+
+		template<class... Args>
+		pair<iterator, bool> emplace(Args&&... args) { return repository.emplace_unique(grtw::forward<Args>(args)...); }
+		template<class... Args>
+		iterator emplace_hint(const_iterator hint, Args&&... args) { return repository.emplace_hint_unique(hint, grtw::forward<Args>(args)...); }
+
+		//the mapped value is only built when k is not present yet
+		template<class... Args>
+		pair<iterator, bool> try_emplace(const Key& k, Args&&... args)
 		{
 			iterator i = lower_bound(k);
-			if(i == end() || repository.key_comp()(k, (*i).first))
-				i = insert(value_type(k, Value())).first;
-			return (*i).second;
+			if(i != end() && !repository.key_comp()(k, (*i).first))
+				return pair<iterator, bool>(i, false);
+			return pair<iterator, bool>(repository.emplace_hint_unique(i, pair_emplace_t(), k, grtw::forward<Args>(args)...), true);
 		}
 
-		pair<iterator, bool> insert(const value_type& x) { return repository.insert_unique(x); }
+		template<class... Args>
+		pair<iterator, bool> try_emplace(Key&& k, Args&&... args)
+		{
+			iterator i = lower_bound(k);
+			if(i != end() && !repository.key_comp()(k, (*i).first))
+				return pair<iterator, bool>(i, false);
+			return pair<iterator, bool>(repository.emplace_hint_unique(i, pair_emplace_t(), grtw::move(k), grtw::forward<Args>(args)...), true);
+		}
 
 		void insert(const value_type* vfirst, const value_type* vlast) { repository.insert_unique(vfirst, vlast); }
 		void insert(const_iterator vfirst, const_iterator vlast) { repository.insert_unique(vfirst, vlast); }
@@ -74,7 +107,7 @@ namespace grtw
 
 		void clear() { repository.clear(); }
 
-		iterator find(const Key& k) { return repository.find(); }
+		iterator find(const Key& k) { return repository.find(k); }
 		const_iterator find(const Key& k) const { return repository.find(k); }
 		size_type count(const Key& k) { return repository.find(k) == repository.end() ? 0 : 1; }
 		iterator lower_bound(const Key& k) { return repository.lower_bound(k); }
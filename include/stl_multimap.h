@@ -5,10 +5,11 @@
 #include"stl_allocator.h"
 #include"stl_rbtree.h"
 #include"stl_pair.h"
+#include"stl_utility.h"
 
 namespace grtw
 {
-	template<class Key, class Value, class Compare = less<Key>, class Alloc>
+	template<class Key, class Value, class Compare = less<Key>, class Alloc = allocator<RBTreeNode<pair<const Key, Value> > > >
 	class multimap
 	{
 	private:
@@ -38,24 +39,37 @@ namespace grtw
 		multimap(const_iterator vfirst, const_iterator vlast) : repository(Compare()) { repository.insert_equal(vfirst, vlast); }
 		multimap(const_iterator vfirst, const_iterator vlast, const Compare& comp) : repository(comp) { repository.insert_equal(vfirst, vlast); }
 		multimap(const multimap<Key, Value, Compare, Alloc>& other) : repository(other.repository) {}
+		multimap(multimap<Key, Value, Compare, Alloc>&& other) : repository(grtw::move(other.repository)) {}
 		multimap<Key, Value, Compare, Alloc>& operator=(const multimap<Key, Value, Compare, Alloc>& other)
 		{
 			repository = other.repository;
 			return *this;
 		}
 
+		multimap<Key, Value, Compare, Alloc>& operator=(multimap<Key, Value, Compare, Alloc>&& other)
+		{
+			repository = grtw::move(other.repository);
+			return *this;
+		}
+
+		void swap(multimap<Key, Value, Compare, Alloc>& other) noexcept { repository.swap(other.repository); }
+
 		iterator begin() { return repository.begin(); }
-		const_iterator begin() { return repository.begin(); }
+		const_iterator begin() const { return repository.begin(); }
 		iterator end() { return repository.end(); }
-		const_iterator end() { return repository.end(); }
+		const_iterator end() const { return repository.end(); }
 		reverse_iterator rbegin() { return repository.rbegin(); }
-		const_reverse_iterator rbegin() { return repository.rbegin(); }
+		const_reverse_iterator rbegin() const { return repository.rbegin(); }
 		reverse_iterator rend() { return repository.rend(); }
-		const_reverse_iterator rend() { return repository.rend(); }
+		const_reverse_iterator rend() const { return repository.rend(); }
 		bool empty() { return repository.empty(); }
 		size_type size() { return repository.size(); }
 
 		iterator insert(const value_type& x) { return repository.insert_equal(x); }
+		iterator insert(value_type&& x) { return repository.insert_equal(grtw::move(x)); }
+
+		template<class... Args>
+		iterator emplace(Args&&... args) { return repository.emplace_equal(grtw::forward<Args>(args)...); }
 
 		void insert(const value_type* vfirst, const value_type* vlast) { repository.insert_equal(vfirst, vlast); }
 		void insert(const_iterator vfirst, const_iterator vlast) { repository.insert_equal(vfirst, vlast); }
@@ -66,9 +80,9 @@ namespace grtw
 
 		void clear() { repository.clear(); }
 
-		iterator find(const Key& k) { return repository.find(); }
+		iterator find(const Key& k) { return repository.find(k); }
 		const_iterator find(const Key& k) const { return repository.find(k); }
-		size_type count(const Key& k) { return repository.find(k) == repository.end() ? 0 : 1; }
+		size_type count(const Key& k) const { return repository.count(k); }
 		iterator lower_bound(const Key& k) { return repository.lower_bound(k); }
 		const_iterator lower_bound(const Key& k) const { return repository.lower_bound(k); }
 		iterator upper_bound(const Key& k) { return repository.upper_bound(k); }
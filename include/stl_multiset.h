@@ -1,9 +1,15 @@
 #ifndef GRTW_STL_MULTISET_H
 #define GRTW_STL_MULTISET_H
 
+#include"stl_allocator.h"
+#include"stl_function.h"
+#include"stl_rbtree.h"
+#include"stl_pair.h"
+#include"stl_utility.h"
+
 namespace grtw
 {
-	template<class Key, class Compare = less<Key>, class Alloc = allocator<Key>>
+	template<class Key, class Compare = less<Key>, class Alloc = allocator<RBTreeNode<Key>>>
 	class multiset
 	{
 	private:
@@ -33,12 +39,21 @@ namespace grtw
 		multiset(const_iterator vfirst, const_iterator vlast) : repository(Compare()) { repository.insert_equal(vfirst, vlast); }
 		multiset(const_iterator vfirst, const_iterator vlast, const Compare& comp) : repository(comp) { repository.insert_equal(vfirst, vlast); }
 		multiset(const multiset<Key, Compare, Alloc>& other) : repository(other.repository) {}
+		multiset(multiset<Key, Compare, Alloc>&& other) : repository(grtw::move(other.repository)) {}
 		multiset<Key, Compare, Alloc>& operator=(const multiset<Key, Compare, Alloc>& other)
 		{
 			repository = other.repository;
 			return *this;
 		}
 
+		multiset<Key, Compare, Alloc>& operator=(multiset<Key, Compare, Alloc>&& other)
+		{
+			repository = grtw::move(other.repository);
+			return *this;
+		}
+
+		void swap(multiset<Key, Compare, Alloc>& other) noexcept { repository.swap(other.repository); }
+
 		iterator begin() const { return repository.begin(); }
 		iterator end() const { return repository.end(); }
 		reverse_iterator rbegin() const { return repository.rbegin(); }
@@ -47,12 +62,16 @@ namespace grtw
 		size_type size() const { return repository.size(); }
 
 		iterator insert(const value_type& x) { return repository.insert_equal(x); }
+		iterator insert(value_type&& x) { return repository.insert_equal(grtw::move(x)); }
+
+		template<class... Args>
+		iterator emplace(Args&&... args) { return repository.emplace_equal(grtw::forward<Args>(args)...); }
 		void insert(const_iterator vfirst, const_iterator vlast) { repository.insert_equal(vfirst, vlast); }
 		void insert(const value_type* vfirst, const value_type* vlast) { repository.insert_equal(vfirst, vlast); }
 
 		void erase(iterator it)
 		{
-			using repo_iterator = repo_type::iterator;
+			using repo_iterator = typename repo_type::iterator;
 			repository.erase((repo_iterator&)it);
 		}
 
@@ -63,14 +82,14 @@ namespace grtw
 
 		void erase(iterator vfirst, iterator vlast)
 		{
-			using repo_iterator = repo_type::iterator;
+			using repo_iterator = typename repo_type::iterator;
 			repository.erase((repo_iterator&)vfirst, (repo_iterator&)vlast);
 		}
 
 		void clear() { repository.clear(); }
 
 		iterator find(const Key& k) const { return repository.find(k); }
-		size_type count(const Key& k) const { return repository.find(k) == repository.end() ? 0 : 1; }
+		size_type count(const Key& k) const { return repository.count(k); }
 		iterator lower_bound(const Key& k) const { return repository.lower_bound(k); }
 		iterator upper_bound(const Key& k) const { return repository.upper_bound(k); }
 		pair<iterator, iterator> equal_range(const Key& k) const { return repository.equal_range(k); }
@@ -1,8 +1,13 @@
 #ifndef GRTW_STL_PAIR_H
 #define GRTW_STL_PAIR_H
 
+#include"stl_utility.h"
+
 namespace grtw
 {
+	//tag for building second in place from the arguments after first
+	struct pair_emplace_t {};
+
 	template<class T1, class T2>
 	struct pair
 	{
@@ -13,7 +18,13 @@ namespace grtw
 		pair() : first(T1()), second(T2()) {}
 		pair(const T1& t1, const T2& t2) :  first(t1), second(t2) {}
 		template<class U1, class U2>
+		pair(U1&& u1, U2&& u2) : first(grtw::forward<U1>(u1)), second(grtw::forward<U2>(u2)) {}
+		template<class U1, class U2>
 		pair(const pair<U1, U2>& p) : first(p.first), second(p.second) {}
+		template<class U1, class U2>
+		pair(pair<U1, U2>&& p) : first(grtw::move(p.first)), second(grtw::move(p.second)) {}
+		template<class U1, class... Args>
+		pair(pair_emplace_t, U1&& u1, Args&&... args) : first(grtw::forward<U1>(u1)), second(grtw::forward<Args>(args)...) {}
 	};
 
 	template<class T1, class T2>
@@ -5,6 +5,7 @@
 #include"stl_vector.h"
 #include"stl_function.h"
 #include"stl_heap.h"
+#include"stl_utility.h"
 
 namespace grtw
 {
@@ -30,8 +31,11 @@ namespace grtw
 		const_reference front() const { return c.front(); }
 		reference back() { return c.back(); }
 		const_reference back() const { return c.back(); }
-		void push(const value_type& x) { c.push(x); }
-		void pop() { c.pop(); }
+		void push(const value_type& x) { c.push_back(x); }
+		void push(value_type&& x) { c.push_back(grtw::move(x)); }
+		template<class... Args>
+		void emplace(Args&&... args) { c.emplace_back(grtw::forward<Args>(args)...); }
+		void pop() { c.pop_front(); }
 	};
 
 	template<class T, class Sequence = vector<T>, class Compare = less<typename Sequence::value_type>>
@@ -65,6 +69,19 @@ namespace grtw
 			push_heap(c.begin(), c.end(), comp);
 		}
 
+		void push(value_type&& x)
+		{
+			c.push_back(grtw::move(x));
+			push_heap(c.begin(), c.end(), comp);
+		}
+
+		template<class... Args>
+		void emplace(Args&&... args)
+		{
+			c.emplace_back(grtw::forward<Args>(args)...);
+			push_heap(c.begin(), c.end(), comp);
+		}
+
 		void pop()
 		{
 			pop_heap(c.begin(), c.end(), comp);
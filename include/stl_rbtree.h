@@ -3,10 +3,12 @@
 
 #include"stl_algorithms.h"
 #include"stl_allocator.h"
+#include"stl_allocator_traits.h"
 #include"stl_construct.h"
 #include"stl_function.h"
 #include"stl_iterator.h"
 #include"stl_pair.h"
+#include"stl_utility.h"
 
 namespace grtw
 {
@@ -22,9 +24,6 @@ namespace grtw
 		RBTreeNode* parent;
 		RBTreeNode* left;
 		RBTreeNode* right;
-
-		RBTreeNode() : value(T()), parent(nullptr), left(nullptr), right(nullptr) {}
-		~RBTreeNode() { destroy(&value); }
 	};
 
 	template<class T, class Reference, class Pointer>
@@ -147,7 +146,7 @@ namespace grtw
 		using pointer = value_type*;
 		using const_pointer = const value_type*;
 		using reference = value_type&;
-		using const_reference = const reference;
+		using const_reference = const value_type&;
 		using size_type = size_t;
 		using difference_type = ptrdiff_t;
 
@@ -155,23 +154,34 @@ namespace grtw
 		using const_iterator = RBTree_iterator<value_type, const_reference, const_pointer>;
 		using reverse_iterator = Reverse_iterator<iterator>;
 		using const_reverse_iterator = Reverse_iterator<const_iterator>;
+		using allocator_type = Alloc;
 
 	private:
-		RBTreeNode<value_type>* header;
+		using alloc_traits = allocator_traits<Alloc>;
+
+		//the allocator is a base of the storage, so a stateless one takes no space
+		struct storage : public Alloc
+		{
+			RBTreeNode<value_type>* header;
+
+			storage(const Alloc& a) : Alloc(a), header(nullptr) {}
+		};
+
+		storage impl;
 		size_type node_count;
 		Compare comp;
 
 	private:
 		static const Key& getKeyOfValue(RBTreeNode<value_type>* n) { return KeyOfValue()(n->value); }
 
-		RBTreeNode<value_type>* leftmost() { return header->left; }
-		RBTreeNode<value_type>* rightmost() { return header->right; }
+		RBTreeNode<value_type>* leftmost() const { return impl.header->left; }
+		RBTreeNode<value_type>* rightmost() const { return impl.header->right; }
 
 		RBTreeNode<value_type>* minimum()
 		{
-			RBTreeNode<value_type>* root = header->parent;
+			RBTreeNode<value_type>* root = impl.header->parent;
 			if(root == nullptr)
-				return header;
+				return impl.header;
 			else
 			{
 				while(root->left != nullptr)
@@ -182,9 +192,9 @@ namespace grtw
 
 		RBTreeNode<value_type>* maximum()
 		{
-			RBTreeNode<value_type>* root = header->parent;
+			RBTreeNode<value_type>* root = impl.header->parent;
 			if(root == nullptr)
-				return header;
+				return impl.header;
 			else
 			{
 				while(root->right != nullptr)
@@ -195,7 +205,7 @@ namespace grtw
 
 		void rotate_left(RBTreeNode<value_type>* node)
 		{
-			if(node != header)
+			if(node != impl.header)
 			{
 				RBTreeNode<value_type>* r = node->right;
 				RBTreeNode<value_type>* p = node->parent;
@@ -206,8 +216,8 @@ namespace grtw
 				if(r->left != nullptr)
 					r->left->parent = node;
 
-				if(p == header)
-					header->parent = r;
+				if(p == impl.header)
+					impl.header->parent = r;
 				else if(p->left == node)
 					p->left = r;
 				else
@@ -220,7 +230,7 @@ namespace grtw
 
 		void rotate_right(RBTreeNode<value_type>* node)
 		{
-			if(node != header)
+			if(node != impl.header)
 			{
 				RBTreeNode<value_type>* l = node->left;
 				RBTreeNode<value_type>* p = node->parent;
@@ -231,8 +241,8 @@ namespace grtw
 				if(l->right != nullptr)
 					l->right->parent = node;
 
-				if(p == header)
-					header->parent = l;
+				if(p == impl.header)
+					impl.header->parent = l;
 				else if(p->right == node)
 					p->right = l;
 				else
@@ -245,16 +255,20 @@ namespace grtw
 		
 		void empty_initialize()
 		{
-			header->color = rb_tree_red;
-			header->parent = nullptr;
-			header->left = header;
-			header->right = header;
+			impl.header->color = rb_tree_red;
+			impl.header->parent = nullptr;
+			impl.header->left = impl.header;
+			impl.header->right = impl.header;
 		}
 
-		RBTreeNode<value_type>* create_node(const value_type& v)
+		RBTreeNode<value_type>* get_node() { return alloc_traits::allocate(impl, 1); }
+		void put_node(RBTreeNode<value_type>* p) { alloc_traits::deallocate(impl, p, 1); }
+
+		template<class... Args>
+		RBTreeNode<value_type>* create_node(Args&&... args)
 		{
-			RBTreeNode<value_type>* tmp = Alloc::allocate(1);
-			construct(&(tmp->value), v);
+			RBTreeNode<value_type>* tmp = get_node();
+			grtw::construct(&(tmp->value), grtw::forward<Args>(args)...);
 			return tmp;
 		}
 
@@ -269,8 +283,8 @@ namespace grtw
 
 		void destroy_node(RBTreeNode<value_type>* node)
 		{
-			destroy(node);
-			Alloc::deallocate(node);
+			grtw::destroy(&(node->value));
+			put_node(node);
 		}
 
 		void clear(RBTreeNode<value_type>* root)
@@ -287,36 +301,49 @@ namespace grtw
 		RBTreeNode<value_type>* rebalance_erase(RBTreeNode<value_type>*);
 		RBTreeNode<value_type>* copy(RBTreeNode<value_type>*);
 
-		iterator insert(RBTreeNode<value_type>*, const value_type&);
+		iterator insert(RBTreeNode<value_type>*, RBTreeNode<value_type>*);
+		RBTreeNode<value_type>* insert_equal_pos(const Key&);
+		pair<RBTreeNode<value_type>*, bool> insert_unique_pos(const Key&);
 
 	public:
-		RBTree() : header(nullptr), node_count(0), comp()
+		RBTree() : impl(Alloc()), node_count(0), comp()
 		{
-			header = Alloc::allocate(1);
+			impl.header = get_node();
 			empty_initialize();
 		}
 
-		RBTree(const Compare& c) : header(nullptr), node_count(0), comp(c)
+		RBTree(const Compare& c, const Alloc& a = Alloc()) : impl(a), node_count(0), comp(c)
 		{
-			header = Alloc::allocate(1);
+			impl.header = get_node();
 			empty_initialize();
 		}
 
-		RBTree(const RBTree<Key, Value, KeyOfValue, Compare, Alloc>& other) : header(nullptr), node_count(0), comp(other.key_comp())
+		RBTree(const RBTree<Key, Value, KeyOfValue, Compare, Alloc>& other)
+			: impl(alloc_traits::select_on_container_copy_construction(other.impl)), node_count(0), comp(other.key_comp())
 		{
-			header = Alloc::allocate(1);
+			impl.header = get_node();
 			if(other.size() == 0)
 				empty_initialize();
 			else
 			{
-				header->color = rb_tree_red;
-				header->parent = copy((other.get_header())->parent);
-				header->left = minimum();
-				header->right = maximum();
+				impl.header->color = rb_tree_red;
+				impl.header->parent = copy((other.get_header())->parent);
+				impl.header->parent->parent = impl.header;
+				impl.header->left = minimum();
+				impl.header->right = maximum();
 			}
 			node_count = other.size();
 		}
 
+		//other keeps a fresh empty header, so it stays usable after the move
+		RBTree(RBTree<Key, Value, KeyOfValue, Compare, Alloc>&& other)
+			: impl(other.impl), node_count(other.node_count), comp(other.comp)
+		{
+			other.impl.header = other.get_node();
+			other.empty_initialize();
+			other.node_count = 0;
+		}
+
 		RBTree<Key, Value, KeyOfValue, Compare, Alloc>& operator=(const RBTree<Key, Value, KeyOfValue, Compare, Alloc>& other)
 		{
 			if(this != &other)
@@ -326,26 +353,50 @@ namespace grtw
 				comp = other.key_comp();
 				if((other.get_header())->parent == nullptr)
 				{
-					header->parent = nullptr;
-					header->left = header;
-					header->right = header;
+					impl.header->parent = nullptr;
+					impl.header->left = impl.header;
+					impl.header->right = impl.header;
 				}
 				else
 				{
-					header->parent = copy((other.get_header())->parent);
-					header->left = minimum();
-					header->right = maximum();
+					impl.header->parent = copy((other.get_header())->parent);
+					impl.header->parent->parent = impl.header;
+					impl.header->left = minimum();
+					impl.header->right = maximum();
 					node_count = other.size();
 				}
 			}
 			return *this;
 		}
 
-		~RBTree() { clear(); }
+		RBTree<Key, Value, KeyOfValue, Compare, Alloc>& operator=(RBTree<Key, Value, KeyOfValue, Compare, Alloc>&& other)
+		{
+			if(this != &other)
+			{
+				clear();
+				swap(other);
+			}
+			return *this;
+		}
+
+		~RBTree()
+		{
+			clear();
+			put_node(impl.header);
+		}
+
+		allocator_type get_allocator() const { return impl; }
+
+		void swap(RBTree<Key, Value, KeyOfValue, Compare, Alloc>& other) noexcept
+		{
+			grtw::swap(impl, other.impl);
+			grtw::swap(node_count, other.node_count);
+			grtw::swap(comp, other.comp);
+		}
 
 		bool operator==(const RBTree<Key, Value, KeyOfValue, Compare, Alloc>& other)
 		{
-			return size() == other.size() && equal(begin(), end(), other.begin());
+			return size() == other.size() && grtw::equal(begin(), end(), other.begin());
 		}
 
 		bool operator!=(const RBTree<Key, Value, KeyOfValue, Compare, Alloc>& other)
@@ -354,12 +405,12 @@ namespace grtw
 		}
 
 		Compare key_comp() const { return comp; }
-		RBTreeNode<value_type>* get_header() const { return header; }
+		RBTreeNode<value_type>* get_header() const { return impl.header; }
 
 		iterator begin() { return leftmost(); }
-		iterator end() { return header; }
+		iterator end() { return impl.header; }
 		const_iterator begin() const { return leftmost(); }
-		const_iterator end() const { return header; }
+		const_iterator end() const { return impl.header; }
 		reverse_iterator rbegin() { return reverse_iterator(end()); }
 		reverse_iterator rend() { return reverse_iterator(begin()); }
 		const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
@@ -368,14 +419,23 @@ namespace grtw
 		bool empty() const { return node_count == 0; }
 		size_type size() const { return node_count; }
 
-		iterator insert_equal(const value_type& v);
+		iterator insert_equal(const value_type& v) { return emplace_equal(v); }
+		iterator insert_equal(value_type&& v) { return emplace_equal(grtw::move(v)); }
 		void insert_equal(const_iterator, const_iterator);
 		void insert_equal(const value_type*, const value_type*);
 
 		pair<iterator, bool> insert_unique(const value_type& v);
+		pair<iterator, bool> insert_unique(value_type&& v);
 		void insert_unique(const_iterator, const_iterator);
 		void insert_unique(const value_type*, const value_type*);
 
+		template<class... Args>
+		iterator emplace_equal(Args&&... args);
+		template<class... Args>
+		pair<iterator, bool> emplace_unique(Args&&... args);
+		template<class... Args>
+		iterator emplace_hint_unique(const_iterator, Args&&... args);
+
 		void erase(iterator);
 		void erase(iterator, iterator);
 		size_type erase(const Key&);
@@ -414,7 +474,7 @@ namespace grtw
 	template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
 	void RBTree<Key, Value, KeyOfValue, Compare, Alloc>::rebalance_insert(RBTreeNode<value_type>* node)
 	{
-		RBTreeNode<value_type>* root = header->parent;
+		RBTreeNode<value_type>* root = impl.header->parent;
 		node->color = rb_tree_red;
 		while(node != root && node->parent->color == rb_tree_red)
 		{
@@ -467,7 +527,7 @@ namespace grtw
 				}
 			}
 		}
-		node->color = rb_tree_black;
+		impl.header->parent->color = rb_tree_black;
 	}
 
 	template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
@@ -479,8 +539,8 @@ namespace grtw
 		RBTreeNode<value_type>* to_fillin_parent = node->parent;
 		if(node->left == nullptr && node->right == nullptr)
 		{
-			if(node == header->parent)
-				header->parent = nullptr;
+			if(node == impl.header->parent)
+				impl.header->parent = nullptr;
 			else if(node->parent->left == node)
 				node->parent->left = nullptr;
 			else
@@ -490,8 +550,8 @@ namespace grtw
 		{
 			to_fillin = (node->left == nullptr) ? node->right : node->left;
 			to_fillin->parent = node->parent;
-			if(node == header->parent)
-				header->parent = to_fillin;
+			if(node == impl.header->parent)
+				impl.header->parent = to_fillin;
 			else if(node->parent->left == node)
 				node->parent->left = to_fillin;
 			else
@@ -516,21 +576,21 @@ namespace grtw
 			else
 				to_fillin_parent = to_erase;
 			to_erase->parent = node->parent;
-			if(node == header->parent)
-				header->parent = to_erase;
+			if(node == impl.header->parent)
+				impl.header->parent = to_erase;
 			else if(node->parent->left == node)
 				node->parent->left = to_erase;
 			else
 				node->parent->right = to_erase;
-			swap(to_erase->color, node->color);
+			grtw::swap(to_erase->color, node->color);
 			to_erase = node;
 		}
-		header->left = minimum();
-		header->right = maximum();
+		impl.header->left = minimum();
+		impl.header->right = maximum();
 
 		if(to_erase->color == rb_tree_black)
 		{
-			while(to_fillin != header->parent && (to_fillin == nullptr || to_fillin->color != rb_tree_red))
+			while(to_fillin != impl.header->parent && (to_fillin == nullptr || to_fillin->color != rb_tree_red))
 			{
 				if(to_fillin_parent->left == to_fillin)
 				{
@@ -550,7 +610,7 @@ namespace grtw
 							to_fillin = to_fillin_parent;
 							to_fillin_parent = to_fillin_parent->parent;
 						}
-						else if(bls->color == rb_tree_red && (brs == nullptr || brs->color == rb_tree_black))
+						else if(bls != nullptr && bls->color == rb_tree_red && (brs == nullptr || brs->color == rb_tree_black))
 						{
 							bls->color = rb_tree_black;
 							to_fillin_parent->right->color = rb_tree_red;
@@ -576,15 +636,15 @@ namespace grtw
 					}
 					else
 					{
-						RBTreeNode<value_type>* bls = to_fillin_parent->right->left;
-						RBTreeNode<value_type>* brs = to_fillin_parent->right->right;
+						RBTreeNode<value_type>* bls = to_fillin_parent->left->left;
+						RBTreeNode<value_type>* brs = to_fillin_parent->left->right;
 						if((bls == nullptr || bls->color == rb_tree_black) && (brs == nullptr || brs->color == rb_tree_black))
 						{
-							to_fillin_parent->right->color = rb_tree_red;
+							to_fillin_parent->left->color = rb_tree_red;
 							to_fillin = to_fillin_parent;
 							to_fillin_parent = to_fillin_parent->parent;
 						}
-						else if(brs->color == rb_tree_red && (bls == nullptr || bls->color == rb_tree_black))
+						else if(brs != nullptr && brs->color == rb_tree_red && (bls == nullptr || bls->color == rb_tree_black))
 						{
 							brs->color = rb_tree_black;
 							to_fillin_parent->left->color = rb_tree_red;
@@ -612,11 +672,11 @@ namespace grtw
 	{
 		if(node_count != 0)
 		{
-			RBTreeNode<value_type>* root = header->parent;
+			RBTreeNode<value_type>* root = impl.header->parent;
 			clear(root);
-			header->left = header;
-			header->right = header;
-			header->parent = nullptr;
+			impl.header->left = impl.header;
+			impl.header->right = impl.header;
+			impl.header->parent = nullptr;
 			node_count = 0;
 		}
 	}
@@ -625,8 +685,8 @@ namespace grtw
 	typename RBTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
 	RBTree<Key, Value, KeyOfValue, Compare, Alloc>::find(const Key& k)
 	{
-		RBTreeNode<value_type>* curr = header->parent;
-		RBTreeNode<value_type>* last_greater = header;
+		RBTreeNode<value_type>* curr = impl.header->parent;
+		RBTreeNode<value_type>* last_greater = impl.header;
 		while(curr != nullptr)
 		{
 			if(comp(getKeyOfValue(curr), k))
@@ -638,15 +698,15 @@ namespace grtw
 			}
 		}
 		iterator res = iterator(last_greater);
-		return (res == end() || comp(k, getKeyOfValue(res->getNative()))) ? end() : res;
+		return (res == end() || comp(k, getKeyOfValue(res.getNative()))) ? end() : res;
 	}
 
 	template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
 	typename RBTree<Key, Value, KeyOfValue, Compare, Alloc>::const_iterator
 	RBTree<Key, Value, KeyOfValue, Compare, Alloc>::find(const Key& k) const
 	{
-		RBTreeNode<value_type>* curr = header->parent;
-		RBTreeNode<value_type>* last_greater = header;
+		RBTreeNode<value_type>* curr = impl.header->parent;
+		RBTreeNode<value_type>* last_greater = impl.header;
 		while(curr != nullptr)
 		{
 			if(comp(getKeyOfValue(curr), k))
@@ -658,31 +718,30 @@ namespace grtw
 			}
 		}
 		const_iterator res = const_iterator(last_greater);
-		return (res == end() || comp(k, getKeyOfValue(res->getNative()))) ? end() : res;
+		return (res == end() || comp(k, getKeyOfValue(res.getNative()))) ? end() : res;
 	}
 
 	template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
 	typename RBTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
-	RBTree<Key, Value, KeyOfValue, Compare, Alloc>::insert(RBTreeNode<value_type>* its_parent, const value_type& v)
+	RBTree<Key, Value, KeyOfValue, Compare, Alloc>::insert(RBTreeNode<value_type>* its_parent, RBTreeNode<value_type>* z)
 	{
-		RBTreeNode<value_type>* z = create_node(v);
-		if(its_parent == header)
+		if(its_parent == impl.header)
 		{
 			its_parent->parent = z;
 			its_parent->left = z;
 			its_parent->right = z;
 		}
-		else if(comp(KeyOfValue()(v), getKeyOfValue(its_parent)))
+		else if(comp(getKeyOfValue(z), getKeyOfValue(its_parent)))
 		{
 			its_parent->left = z;
 			if(its_parent == leftmost())
-				header->left = z;
+				impl.header->left = z;
 		}
 		else
 		{
 			its_parent->right = z;
 			if(its_parent == rightmost())
-				header->right = z;
+				impl.header->right = z;
 		}
 		z->parent = its_parent;
 		z->left = nullptr;
@@ -693,17 +752,54 @@ namespace grtw
 	}
 
 	template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
-	typename RBTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
-	RBTree<Key, Value, KeyOfValue, Compare, Alloc>::insert_equal(const value_type& v)
+	RBTreeNode<typename RBTree<Key, Value, KeyOfValue, Compare, Alloc>::value_type>*
+	RBTree<Key, Value, KeyOfValue, Compare, Alloc>::insert_equal_pos(const Key& k)
 	{
-		RBTreeNode<value_type>* p = header;
+		RBTreeNode<value_type>* p = impl.header;
 		RBTreeNode<value_type>* c = p->parent;
 		while(c != nullptr)
 		{
 			p = c;
-			c = comp(KeyOfValue()(v), getKeyOfValue(c)) ? c->left : c->right;
+			c = comp(k, getKeyOfValue(c)) ? c->left : c->right;
 		}
-		return insert(p, v);
+		return p;
+	}
+
+	//returns the parent to link a node with key k under, or the node already holding k
+	template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+	pair<RBTreeNode<typename RBTree<Key, Value, KeyOfValue, Compare, Alloc>::value_type>*, bool>
+	RBTree<Key, Value, KeyOfValue, Compare, Alloc>::insert_unique_pos(const Key& k)
+	{
+		RBTreeNode<value_type>* p = impl.header;
+		RBTreeNode<value_type>* c = impl.header->parent;
+		bool go_left = true;
+		while(c != nullptr)
+		{
+			p = c;
+			go_left = comp(k, getKeyOfValue(c));
+			c = go_left ? c->left : c->right;
+		}
+		iterator it = iterator(p);
+		if(go_left)
+		{
+			if(it == begin())
+				return pair<RBTreeNode<value_type>*, bool>(p, true);
+			else
+				--it;
+		}
+		if(comp(getKeyOfValue(it.getNative()), k))
+			return pair<RBTreeNode<value_type>*, bool>(p, true);
+		else
+			return pair<RBTreeNode<value_type>*, bool>(it.getNative(), false);
+	}
+
+	template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+	template<class... Args>
+	typename RBTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+	RBTree<Key, Value, KeyOfValue, Compare, Alloc>::emplace_equal(Args&&... args)
+	{
+		RBTreeNode<value_type>* z = create_node(grtw::forward<Args>(args)...);
+		return insert(insert_equal_pos(getKeyOfValue(z)), z);
 	}
 
 	template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
@@ -724,25 +820,68 @@ namespace grtw
 	pair<typename RBTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator, bool>
 	RBTree<Key, Value, KeyOfValue, Compare, Alloc>::insert_unique(const value_type& v)
 	{
-		RBTreeNode<value_type>* p = header;
-		RBTreeNode<value_type>* c = header->parent;
-		while(c != nullptr)
+		pair<RBTreeNode<value_type>*, bool> pos = insert_unique_pos(KeyOfValue()(v));
+		if(pos.second)
+			return pair<iterator, bool>(insert(pos.first, create_node(v)), true);
+		return pair<iterator, bool>(iterator(pos.first), false);
+	}
+
+	template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+	pair<typename RBTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator, bool>
+	RBTree<Key, Value, KeyOfValue, Compare, Alloc>::insert_unique(value_type&& v)
+	{
+		pair<RBTreeNode<value_type>*, bool> pos = insert_unique_pos(KeyOfValue()(v));
+		if(pos.second)
+			return pair<iterator, bool>(insert(pos.first, create_node(grtw::move(v))), true);
+		return pair<iterator, bool>(iterator(pos.first), false);
+	}
+
+	//the key is only known once the value is built, so a duplicate costs a node
+	template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+	template<class... Args>
+	pair<typename RBTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator, bool>
+	RBTree<Key, Value, KeyOfValue, Compare, Alloc>::emplace_unique(Args&&... args)
+	{
+		RBTreeNode<value_type>* z = create_node(grtw::forward<Args>(args)...);
+		pair<RBTreeNode<value_type>*, bool> pos = insert_unique_pos(getKeyOfValue(z));
+		if(pos.second)
+			return pair<iterator, bool>(insert(pos.first, z), true);
+		destroy_node(z);
+		return pair<iterator, bool>(iterator(pos.first), false);
+	}
+
+	//a hint naming the element just after the new key links it without searching the tree
+	template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
+	template<class... Args>
+	typename RBTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
+	RBTree<Key, Value, KeyOfValue, Compare, Alloc>::emplace_hint_unique(const_iterator hint, Args&&... args)
+	{
+		RBTreeNode<value_type>* z = create_node(grtw::forward<Args>(args)...);
+		const Key& k = getKeyOfValue(z);
+		RBTreeNode<value_type>* h = hint.getNative();
+		if(h == impl.header)
 		{
-			p = c;
-			c = comp(KeyOfValue()(v), getKeyOfValue(c)) ? c->left : c->right;
+			if(node_count > 0 && comp(getKeyOfValue(rightmost()), k))
+				return insert(rightmost(), z);
 		}
-		iterator it = iterator(p);
-		if(comp(KeyOfValue()(v), getKeyOfValue(p)))
+		else if(comp(k, getKeyOfValue(h)))
 		{
-			if(it == begin())
-				return pair<iterator, bool>(insert(p, v), true);
-			else
-				--it;
+			if(h == leftmost())
+				return insert(h, z);
+			RBTreeNode<value_type>* before = (--iterator(h)).getNative();
+			if(comp(getKeyOfValue(before), k))
+				return before->right == nullptr ? insert(before, z) : insert(h, z);
 		}
-		if(comp(getKeyOfValue(it.getNative()), KeyOfValue()(v)))
-			return pair<iterator, bool>(insert(p, v), true);
-		else
-			return pair<iterator, bool>(it, false);
+		else if(!comp(getKeyOfValue(h), k))
+		{
+			destroy_node(z);
+			return iterator(h);
+		}
+		pair<RBTreeNode<value_type>*, bool> pos = insert_unique_pos(k);
+		if(pos.second)
+			return insert(pos.first, z);
+		destroy_node(z);
+		return iterator(pos.first);
 	}
 
 	template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
@@ -763,8 +902,8 @@ namespace grtw
 	typename RBTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
 	RBTree<Key, Value, KeyOfValue, Compare, Alloc>::lower_bound(const Key& k)
 	{
-		RBTreeNode<value_type>* p = header;
-		RBTreeNode<value_type>* c = header->parent;
+		RBTreeNode<value_type>* p = impl.header;
+		RBTreeNode<value_type>* c = impl.header->parent;
 		while(c != nullptr)
 		{
 			if(!comp(getKeyOfValue(c), k))
@@ -782,8 +921,8 @@ namespace grtw
 	typename RBTree<Key, Value, KeyOfValue, Compare, Alloc>::const_iterator
 	RBTree<Key, Value, KeyOfValue, Compare, Alloc>::lower_bound(const Key& k) const
 	{
-		RBTreeNode<value_type>* p = header;
-		RBTreeNode<value_type>* c = header->parent;
+		RBTreeNode<value_type>* p = impl.header;
+		RBTreeNode<value_type>* c = impl.header->parent;
 		while(c != nullptr)
 		{
 			if(!comp(getKeyOfValue(c), k))
@@ -801,8 +940,8 @@ namespace grtw
 	typename RBTree<Key, Value, KeyOfValue, Compare, Alloc>::iterator
 	RBTree<Key, Value, KeyOfValue, Compare, Alloc>::upper_bound(const Key& k)
 	{
-		RBTreeNode<value_type>* p = header;
-		RBTreeNode<value_type>* c = header->parent;
+		RBTreeNode<value_type>* p = impl.header;
+		RBTreeNode<value_type>* c = impl.header->parent;
 		while(c != nullptr)
 		{
 			if(comp(k, getKeyOfValue(c)))
@@ -820,8 +959,8 @@ namespace grtw
 	typename RBTree<Key, Value, KeyOfValue, Compare, Alloc>::const_iterator
 	RBTree<Key, Value, KeyOfValue, Compare, Alloc>::upper_bound(const Key& k) const
 	{
-		RBTreeNode<value_type>* p = header;
-		RBTreeNode<value_type>* c = header->parent;
+		RBTreeNode<value_type>* p = impl.header;
+		RBTreeNode<value_type>* c = impl.header->parent;
 		while(c != nullptr)
 		{
 			if(comp(k, getKeyOfValue(c)))
@@ -855,14 +994,14 @@ namespace grtw
 	{
 		pair<const_iterator, const_iterator> p = equal_range(k);
 		size_type c = 0;
-		distance(p.first, p.second, c);
+		grtw::distance(p.first, p.second, c);
 		return c;
 	}
 
 	template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
 	void RBTree<Key, Value, KeyOfValue, Compare, Alloc>::erase(iterator it)
 	{
-		RBTreeNode<value_type>* erased = rebalance_erase(getNative(it));
+		RBTreeNode<value_type>* erased = rebalance_erase(it.getNative());
 		destroy_node(erased);
 		--node_count;
 	}
@@ -874,7 +1013,7 @@ namespace grtw
 			clear();
 		else
 			while(itfirst != itlast)
-				erase(itfirst);
+				erase(itfirst++);
 	}
 
 	template<class Key, class Value, class KeyOfValue, class Compare, class Alloc>
@@ -883,7 +1022,7 @@ namespace grtw
 	{
 		pair<iterator, iterator> p = equal_range(k);
 		size_type c = 0;
-		distance(p.first, p.second, c);
+		grtw::distance(p.first, p.second, c);
 		erase(p.first, p.second);
 		return c;
 	}
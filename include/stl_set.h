@@ -5,10 +5,11 @@
 #include"stl_function.h"
 #include"stl_rbtree.h"
 #include"stl_pair.h"
+#include"stl_utility.h"
 
 namespace grtw
 {
-	template<class Key, class Compare = less<Key>, class Alloc = allocator<Key>>
+	template<class Key, class Compare = less<Key>, class Alloc = allocator<RBTreeNode<Key>>>
 	class set
 	{
 	private:
@@ -38,12 +39,21 @@ namespace grtw
 		set(const_iterator vfirst, const_iterator vlast) : repository(Compare()) { repository.insert_unique(vfirst, vlast); }
 		set(const_iterator vfirst, const_iterator vlast, const Compare& comp) : repository(comp) { repository.insert_unique(vfirst, vlast); }
 		set(const set<Key, Compare, Alloc>& other) : repository(other.repository) {}
+		set(set<Key, Compare, Alloc>&& other) : repository(grtw::move(other.repository)) {}
 		set<Key, Compare, Alloc>& operator=(const set<Key, Compare, Alloc>& other)
 		{
 			repository = other.repository;
 			return *this;
 		}
 
+		set<Key, Compare, Alloc>& operator=(set<Key, Compare, Alloc>&& other)
+		{
+			repository = grtw::move(other.repository);
+			return *this;
+		}
+
+		void swap(set<Key, Compare, Alloc>& other) noexcept { repository.swap(other.repository); }
+
 		iterator begin() const { return repository.begin(); }
 		iterator end() const { return repository.end(); }
 		reverse_iterator rbegin() const { return repository.rbegin(); }
@@ -54,15 +64,31 @@ namespace grtw
 		pair<iterator, bool> insert(const value_type& x)
 		{
 			pair<typename repo_type::iterator, bool> p = repository.insert_unique(x);
-			return pair<iterator, bool(p.first, p.second);
+			return pair<iterator, bool>(p.first, p.second);
+		}
+
+		pair<iterator, bool> insert(value_type&& x)
+		{
+			pair<typename repo_type::iterator, bool> p = repository.insert_unique(grtw::move(x));
+			return pair<iterator, bool>(p.first, p.second);
+		}
+
+		template<class... Args>
+		pair<iterator, bool> emplace(Args&&... args)
+		{
+			pair<typename repo_type::iterator, bool> p = repository.emplace_unique(grtw::forward<Args>(args)...);
+			return pair<iterator, bool>(p.first, p.second);
 		}
 
+		template<class... Args>
+		iterator emplace_hint(const_iterator hint, Args&&... args) { return repository.emplace_hint_unique(hint, grtw::forward<Args>(args)...); }
+
 		void insert(const_iterator vfirst, const_iterator vlast) { repository.insert_unique(vfirst, vlast); }
 		void insert(const value_type* vfirst, const value_type* vlast) { repository.insert_unique(vfirst, vlast); }
 
 		void erase(iterator it)
 		{
-			using repo_iterator = repo_type::iterator;
+			using repo_iterator = typename repo_type::iterator;
 			repository.erase((repo_iterator&)it);
 		}
 
@@ -73,7 +99,7 @@ namespace grtw
 
 		void erase(iterator vfirst, iterator vlast)
 		{
-			using repo_iterator = repo_type::iterator;
+			using repo_iterator = typename repo_type::iterator;
 			repository.erase((repo_iterator&)vfirst, (repo_iterator&)vlast);
 		}
 
@@ -0,0 +1,202 @@
+#ifndef GRTW_STL_SMALL_VECTOR_H
+#define GRTW_STL_SMALL_VECTOR_H
+
+#include<cstring>
+#include"stl_alloc.h"
+#include"stl_allocator.h"
+#include"stl_vector.h"
+#include"stl_utility.h"
+
+namespace grtw
+{
+	//small_buffer_allocator: hands out its inline buffer of N objects for the first request
+	//that fits, everything else goes to allocator<T, Alloc>. The buffer is part of the
+	//allocator object, so copies start with a fresh, unused buffer of their own
+	template<class T, size_t N, class Alloc = default_alloc>
+	class small_buffer_allocator
+	{
+	public:
+		using value_type = T;
+		using pointer = T*;
+		using const_pointer = const T*;
+		using reference = T&;
+		using const_reference = const T&;
+		using size_type = size_t;
+		using difference_type = ptrdiff_t;
+
+		small_buffer_allocator() : in_use(false) {}
+		small_buffer_allocator(const small_buffer_allocator&) : in_use(false) {}
+		small_buffer_allocator& operator=(const small_buffer_allocator&) { return *this; }
+
+		T* allocate(size_t n)
+		{
+			if(n <= N && !in_use)
+			{
+				in_use = true;
+				return inline_buffer();
+			}
+			return heap_alloc::allocate(n);
+		}
+
+		void deallocate(T* p, size_t n)
+		{
+			if(p == inline_buffer())
+				in_use = false;
+			else
+				heap_alloc::deallocate(p, n);
+		}
+
+		//only called by vector for trivially relocatable T
+		T* reallocate(T* p, size_t old_n, size_t new_n)
+		{
+			if(p != inline_buffer())
+				return heap_alloc::reallocate(p, old_n, new_n);
+			if(new_n <= N)
+				return p;
+			T* res = heap_alloc::allocate(new_n);
+			memcpy((void*)res, (const void*)p, sizeof(T) * old_n);
+			in_use = false;
+			return res;
+		}
+
+		T* inline_buffer() { return reinterpret_cast<T*>(buffer); }
+		const T* inline_buffer() const { return reinterpret_cast<const T*>(buffer); }
+
+	private:
+		using heap_alloc = allocator<T, Alloc>;
+
+		alignas(T) unsigned char buffer[sizeof(T) * N];
+		bool in_use;
+	};
+
+	//small_vector: a vector whose first N elements live inside the object, so short vectors
+	//never touch the heap; past N it grows through Alloc like any vector
+	template<class T, size_t N, class Alloc = default_alloc, class Growth = growth_double>
+	class small_vector : public vector<T, small_buffer_allocator<T, N, Alloc>, Growth>
+	{
+	private:
+		using base = vector<T, small_buffer_allocator<T, N, Alloc>, Growth>;
+
+	public:
+		using value_type = typename base::value_type;
+		using size_type = typename base::size_type;
+		using iterator = typename base::iterator;
+		using const_iterator = typename base::const_iterator;
+
+		static const size_type inline_capacity = N;
+
+		small_vector() { this->reserve(N); }
+
+		explicit small_vector(size_type n)
+		{
+			this->reserve(grtw::max(N, n));
+			this->insert(this->end(), n, T());
+		}
+
+		small_vector(size_type n, const T& v)
+		{
+			this->reserve(grtw::max(N, n));
+			this->insert(this->end(), n, v);
+		}
+
+		small_vector(const T* first, const T* last)
+		{
+			this->reserve(grtw::max(N, size_type(last - first)));
+			this->insert(this->end(), first, last);
+		}
+
+		small_vector(const small_vector& other)
+		{
+			this->reserve(grtw::max(N, other.size()));
+			this->insert(this->end(), other.begin(), other.end());
+		}
+
+		//inline elements are moved one by one, a heap buffer is taken over
+		small_vector(small_vector&& other)
+		{
+			if(other.is_inline())
+			{
+				this->reserve(N);
+				move_elements(other);
+			}
+			else
+			{
+				base::swap(other);
+				other.reserve(N);
+			}
+		}
+
+		small_vector& operator=(const small_vector& other)
+		{
+			if(this != &other)
+			{
+				this->clear();
+				this->reserve(other.size());
+				this->insert(this->end(), other.begin(), other.end());
+			}
+			return *this;
+		}
+
+		small_vector& operator=(small_vector&& other)
+		{
+			if(this != &other)
+			{
+				this->clear();
+				if(other.is_inline())
+				{
+					if(!is_inline())
+					{
+						base::shrink_to_fit();
+						this->reserve(N);
+					}
+					move_elements(other);
+				}
+				else
+				{
+					base::shrink_to_fit();
+					base::swap(other);
+					other.reserve(N);
+				}
+			}
+			return *this;
+		}
+
+		void swap(small_vector& other)
+		{
+			if(!is_inline() && !other.is_inline())
+				base::swap(other);
+			else
+			{
+				small_vector tmp(grtw::move(other));
+				other = grtw::move(*this);
+				*this = grtw::move(tmp);
+			}
+		}
+
+		//shrinking never goes below the inline capacity, elements that fit move back inside
+		void shrink_to_fit()
+		{
+			if(is_inline())
+				return;
+			if(this->size() <= N)
+			{
+				small_vector tmp(grtw::move(*this));
+				move_elements(tmp);
+			}
+			else
+				base::shrink_to_fit();
+		}
+
+		bool is_inline() const { return this->begin() == this->allocator_instance().inline_buffer(); }
+
+	private:
+		void move_elements(small_vector& other)
+		{
+			for(iterator it = other.begin(); it != other.end(); ++it)
+				this->emplace_back(grtw::move(*it));
+			other.clear();
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,441 @@
+#ifndef GRTW_STL_SOA_VECTOR_H
+#define GRTW_STL_SOA_VECTOR_H
+
+#include<cstddef>
+#include"stl_iterator_base.h"
+#include"stl_allocator.h"
+#include"stl_construct.h"
+#include"stl_uninitialized.h"
+#include"stl_algorithms.h"
+#include"stl_vector.h"
+#include"stl_utility.h"
+
+namespace grtw
+{
+	//one buffer per field, all of the same capacity; each level owns the column of its first
+	//field and hands the rest to its base
+	template<class Alloc, class... Fields>
+	struct soa_columns
+	{
+		void reallocate(size_t, size_t, size_t) {}
+		void deallocate(size_t) {}
+		void destroy(size_t, size_t) {}
+		void construct(size_t) {}
+		void copy_construct(const soa_columns&, size_t) {}
+		void assign_row(size_t, const soa_columns&, size_t) {}
+		void swap_row(size_t, soa_columns&, size_t) {}
+		void swap(soa_columns&) {}
+	};
+
+	template<class Alloc, class F, class... Rest>
+	struct soa_columns<Alloc, F, Rest...> : public soa_columns<Alloc, Rest...>
+	{
+		using base = soa_columns<Alloc, Rest...>;
+		using alloc = allocator<F, Alloc>;
+
+		//holds a new buffer until it is committed, so the buffer is freed when a later
+		//column fails to allocate
+		struct buffer_guard
+		{
+			F* p;
+			size_t n;
+
+			buffer_guard(F* b, size_t cap) : p(b), n(cap) {}
+			~buffer_guard()
+			{
+				if(p != nullptr)
+					alloc::deallocate(p, n);
+			}
+
+			F* release()
+			{
+				F* res = p;
+				p = nullptr;
+				return res;
+			}
+		};
+
+		F* data;
+
+		soa_columns() : data(nullptr) {}
+
+		//every column's buffer is allocated before any column is moved: the recursion
+		//allocates on the way in and relocates on the way out, so a failed allocation
+		//leaves all columns where they were
+		void reallocate(size_t size, size_t old_cap, size_t new_cap)
+		{
+			buffer_guard tmp(alloc::allocate(new_cap), new_cap);
+			base::reallocate(size, old_cap, new_cap);
+			grtw::uninitialized_relocate(data, data + size, tmp.p);
+			alloc::deallocate(data, old_cap);
+			data = tmp.release();
+		}
+
+		void deallocate(size_t cap)
+		{
+			alloc::deallocate(data, cap);
+			base::deallocate(cap);
+		}
+
+		void destroy(size_t first, size_t last)
+		{
+			grtw::destroy(data + first, data + last);
+			base::destroy(first, last);
+		}
+
+		void construct(size_t i)
+		{
+			grtw::construct(data + i);
+			base::construct(i);
+		}
+
+		template<class Arg, class... Args>
+		void construct(size_t i, Arg&& arg, Args&&... args)
+		{
+			grtw::construct(data + i, grtw::forward<Arg>(arg));
+			base::construct(i, grtw::forward<Args>(args)...);
+		}
+
+		void copy_construct(const soa_columns& other, size_t n)
+		{
+			grtw::uninitialized_copy(other.data, other.data + n, data);
+			base::copy_construct(other, n);
+		}
+
+		void assign_row(size_t i, const soa_columns& other, size_t j)
+		{
+			data[i] = other.data[j];
+			base::assign_row(i, other, j);
+		}
+
+		void swap_row(size_t i, soa_columns& other, size_t j)
+		{
+			grtw::swap(data[i], other.data[j]);
+			base::swap_row(i, other, j);
+		}
+
+		void swap(soa_columns& other)
+		{
+			grtw::swap(data, other.data);
+			base::swap(other);
+		}
+	};
+
+	//the type and buffer of column I
+	template<size_t I, class Alloc, class... Fields>
+	struct soa_column_at;
+
+	template<class Alloc, class F, class... Rest>
+	struct soa_column_at<0, Alloc, F, Rest...>
+	{
+		using type = F;
+
+		static F* data(const soa_columns<Alloc, F, Rest...>& c) { return c.data; }
+	};
+
+	template<size_t I, class Alloc, class F, class... Rest>
+	struct soa_column_at<I, Alloc, F, Rest...>
+	{
+		using next = soa_column_at<I - 1, Alloc, Rest...>;
+		using type = typename next::type;
+
+		static type* data(const soa_columns<Alloc, F, Rest...>& c) { return next::data(c); }
+	};
+
+	//soa_reference: proxy for row index of a soa_vector (Vec may be const); assigning one row
+	//to another copies every field, get<I>() reaches a single one
+	template<class Vec>
+	class soa_reference
+	{
+	public:
+		soa_reference(Vec* v, size_t i) : vec(v), index(i) {}
+		template<class U>
+		soa_reference(const soa_reference<U>& other) : vec(other.container()), index(other.row()) {}
+
+		soa_reference& operator=(const soa_reference& other)
+		{
+			vec->assign_row(index, *other.container(), other.row());
+			return *this;
+		}
+
+		template<class U>
+		soa_reference& operator=(const soa_reference<U>& other)
+		{
+			vec->assign_row(index, *other.container(), other.row());
+			return *this;
+		}
+
+		template<size_t I>
+		auto get() const -> decltype(grtw::declval<Vec&>().template column<I>()[0])
+		{
+			return vec->template column<I>()[index];
+		}
+
+		Vec* container() const { return vec; }
+		size_t row() const { return index; }
+
+	private:
+		Vec* vec;
+		size_t index;
+	};
+
+	template<class Vec>
+	inline void swap(soa_reference<Vec> a, soa_reference<Vec> b)
+	{
+		a.container()->swap_row(a.row(), *b.container(), b.row());
+	}
+
+	//soa_iterator: random access over rows, dereferencing to a soa_reference
+	template<class Vec>
+	class soa_iterator
+	{
+	public:
+		using iterator_category = random_access_iterator_tag;
+		using value_type = soa_reference<Vec>;
+		using difference_type = ptrdiff_t;
+		using pointer = void;
+		using reference = soa_reference<Vec>;
+
+		using self = soa_iterator<Vec>;
+
+		soa_iterator() : vec(nullptr), index(0) {}
+		soa_iterator(Vec* v, size_t i) : vec(v), index(i) {}
+		template<class U>
+		soa_iterator(const soa_iterator<U>& other) : vec(other.container()), index(other.row()) {}
+
+		reference operator*() const { return reference(vec, index); }
+		reference operator[](difference_type n) const { return reference(vec, index + n); }
+
+		self& operator++()
+		{
+			++index;
+			return *this;
+		}
+
+		self operator++(int)
+		{
+			self tmp = *this;
+			++index;
+			return tmp;
+		}
+
+		self& operator--()
+		{
+			--index;
+			return *this;
+		}
+
+		self operator--(int)
+		{
+			self tmp = *this;
+			--index;
+			return tmp;
+		}
+
+		self& operator+=(difference_type n)
+		{
+			index += n;
+			return *this;
+		}
+
+		self& operator-=(difference_type n)
+		{
+			index -= n;
+			return *this;
+		}
+
+		self operator+(difference_type n) const { return self(vec, index + n); }
+		self operator-(difference_type n) const { return self(vec, index - n); }
+		difference_type operator-(const self& x) const { return difference_type(index) - difference_type(x.index); }
+
+		bool operator==(const self& x) const { return index == x.index; }
+		bool operator!=(const self& x) const { return index != x.index; }
+		bool operator<(const self& x) const { return index < x.index; }
+		bool operator>(const self& x) const { return x.index < index; }
+		bool operator<=(const self& x) const { return !(x.index < index); }
+		bool operator>=(const self& x) const { return !(index < x.index); }
+
+		Vec* container() const { return vec; }
+		size_t row() const { return index; }
+
+	private:
+		Vec* vec;
+		size_t index;
+	};
+
+	//basic_soa_vector: a vector of records stored as one contiguous column per field, so a
+	//scan over a field only loads that field. column<I>() is a plain array of size() elements
+	//that copy, fill and the other algorithms take directly. Each column comes from
+	//allocator<Field, Alloc>; Alloc leads because the fields are a pack
+	template<class Alloc, class... Fields>
+	class basic_soa_vector
+	{
+		static_assert(sizeof...(Fields) > 0, "soa_vector needs at least one field");
+
+	public:
+		using reference = soa_reference<basic_soa_vector>;
+		using const_reference = soa_reference<const basic_soa_vector>;
+		using iterator = soa_iterator<basic_soa_vector>;
+		using const_iterator = soa_iterator<const basic_soa_vector>;
+		using size_type = size_t;
+		using difference_type = ptrdiff_t;
+
+		static const size_t field_count = sizeof...(Fields);
+
+		template<size_t I>
+		using field_type = typename soa_column_at<I, Alloc, Fields...>::type;
+
+	private:
+		using columns = soa_columns<Alloc, Fields...>;
+
+		columns impl;
+		size_type count;
+		size_type cap;
+
+		void reallocate_exact(size_type n)
+		{
+			impl.reallocate(count, cap, n);
+			cap = n;
+		}
+
+		void make_room(size_type n)
+		{
+			if(n > cap - count)
+				reallocate_exact(growth_double()(cap, count + n));
+		}
+
+	public:
+		basic_soa_vector() : count(0), cap(0) {}
+
+		explicit basic_soa_vector(size_type n) : count(0), cap(0)
+		{
+			resize(n);
+		}
+
+		basic_soa_vector(const basic_soa_vector& other) : count(0), cap(0)
+		{
+			reallocate_exact(other.count);
+			impl.copy_construct(other.impl, other.count);
+			count = other.count;
+		}
+
+		basic_soa_vector(basic_soa_vector&& other) noexcept : count(0), cap(0)
+		{
+			swap(other);
+		}
+
+		basic_soa_vector& operator=(const basic_soa_vector& other)
+		{
+			if(this != &other)
+			{
+				basic_soa_vector tmp(other);
+				swap(tmp);
+			}
+			return *this;
+		}
+
+		basic_soa_vector& operator=(basic_soa_vector&& other) noexcept
+		{
+			basic_soa_vector tmp(grtw::move(other));
+			swap(tmp);
+			return *this;
+		}
+
+		~basic_soa_vector()
+		{
+			impl.destroy(0, count);
+			impl.deallocate(cap);
+		}
+
+		void swap(basic_soa_vector& other) noexcept
+		{
+			impl.swap(other.impl);
+			grtw::swap(count, other.count);
+			grtw::swap(cap, other.cap);
+		}
+
+		iterator begin() { return iterator(this, 0); }
+		iterator end() { return iterator(this, count); }
+		const_iterator begin() const { return const_iterator(this, 0); }
+		const_iterator end() const { return const_iterator(this, count); }
+		const_iterator cbegin() const { return const_iterator(this, 0); }
+		const_iterator cend() const { return const_iterator(this, count); }
+
+		bool empty() const { return count == 0; }
+		size_type size() const { return count; }
+		size_type capacity() const { return cap; }
+
+		reference operator[](size_type n) { return reference(this, n); }
+		const_reference operator[](size_type n) const { return const_reference(this, n); }
+		reference front() { return reference(this, 0); }
+		reference back() { return reference(this, count - 1); }
+		const_reference front() const { return const_reference(this, 0); }
+		const_reference back() const { return const_reference(this, count - 1); }
+
+		//the column of field I: [column<I>(), column<I>() + size())
+		template<size_t I>
+		field_type<I>* column() { return soa_column_at<I, Alloc, Fields...>::data(impl); }
+		template<size_t I>
+		const field_type<I>* column() const { return soa_column_at<I, Alloc, Fields...>::data(impl); }
+
+		void reserve(size_type n)
+		{
+			if(n > cap)
+				reallocate_exact(n);
+		}
+
+		void shrink_to_fit()
+		{
+			if(cap > count)
+				reallocate_exact(count);
+		}
+
+		void push_back(const Fields&... fields) { emplace_back(fields...); }
+
+		//one argument per field, each constructs its own column's element
+		template<class... Args>
+		void emplace_back(Args&&... args)
+		{
+			static_assert(sizeof...(Args) == sizeof...(Fields), "emplace_back takes one argument per field");
+			make_room(1);
+			impl.construct(count, grtw::forward<Args>(args)...);
+			++count;
+		}
+
+		void pop_back()
+		{
+			--count;
+			impl.destroy(count, count + 1);
+		}
+
+		void resize(size_type n)
+		{
+			if(n < count)
+			{
+				impl.destroy(n, count);
+				count = n;
+			}
+			else
+			{
+				make_room(n - count);
+				for(; count < n; ++count)
+					impl.construct(count);
+			}
+		}
+
+		void clear()
+		{
+			impl.destroy(0, count);
+			count = 0;
+		}
+
+		//row operations used by soa_reference
+		void assign_row(size_type i, const basic_soa_vector& other, size_type j) { impl.assign_row(i, other.impl, j); }
+		void swap_row(size_type i, basic_soa_vector& other, size_type j) { impl.swap_row(i, other.impl, j); }
+	};
+
+	template<class... Fields>
+	using soa_vector = basic_soa_vector<default_alloc, Fields...>;
+}
+
+#endif
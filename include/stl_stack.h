@@ -2,6 +2,7 @@
 #define GRTW_STL_STACK_H
 
 #include"stl_deque.h"
+#include"stl_utility.h"
 
 namespace grtw
 {
@@ -23,9 +24,12 @@ namespace grtw
 		explicit stack(const Sequence& s) : c(s) {}
 		bool empty() const { return c.empty(); }
 		size_type size() const { return c.size(); }
-		reference top() ( return c.back(); )
+		reference top() { return c.back(); }
 		const_reference top() const { return c.back(); }
 		void push(const value_type& v) { c.push_back(v); }
+		void push(value_type&& v) { c.push_back(grtw::move(v)); }
+		template<class... Args>
+		void emplace(Args&&... args) { c.emplace_back(grtw::forward<Args>(args)...); }
 		void pop() { c.pop_back(); }
 	};
 }
@@ -0,0 +1,324 @@
+#ifndef GRTW_STL_STATIC_VECTOR_H
+#define GRTW_STL_STATIC_VECTOR_H
+
+#include<cstddef>
+#include<new>
+#include"stl_iterator.h"
+#include"stl_construct.h"
+#include"stl_uninitialized.h"
+#include"stl_utility.h"
+
+//constexpr functions with loops and assignments need C++14
+#if __cplusplus >= 201402L
+#define GRTW_CONSTEXPR14 constexpr
+#else
+#define GRTW_CONSTEXPR14
+#endif
+
+namespace grtw
+{
+	//storage for trivial T is a plain array, which keeps the container usable in constant
+	//expressions; other types get raw storage and are constructed in place
+	template<class T, size_t N, bool Trivial = __is_trivially_copyable(T) && __is_trivially_constructible(T)>
+	struct static_vector_storage
+	{
+		T elems[N];
+		size_t count;
+
+		constexpr static_vector_storage() : elems(), count(0) {}
+
+		GRTW_CONSTEXPR14 T* data() { return elems; }
+		constexpr const T* data() const { return elems; }
+
+		template<class... Args>
+		static GRTW_CONSTEXPR14 void construct(T* p, Args&&... args) { *p = T(grtw::forward<Args>(args)...); }
+		static GRTW_CONSTEXPR14 void destroy(T*, T*) {}
+
+		static GRTW_CONSTEXPR14 T* uninitialized_copy(const T* first, const T* last, T* dest)
+		{
+			for(; first != last; ++first, ++dest)
+				*dest = *first;
+			return dest;
+		}
+
+		static GRTW_CONSTEXPR14 T* uninitialized_fill_n(T* dest, size_t n, const T& v)
+		{
+			for(; n > 0; --n, ++dest)
+				*dest = v;
+			return dest;
+		}
+	};
+
+	template<class T, size_t N>
+	struct static_vector_storage<T, N, false>
+	{
+		alignas(T) unsigned char raw[sizeof(T) * N];
+		size_t count;
+
+		static_vector_storage() : count(0) {}
+
+		static_vector_storage(const static_vector_storage& other) : count(other.count)
+		{
+			grtw::uninitialized_copy(other.data(), other.data() + count, data());
+		}
+
+		static_vector_storage(static_vector_storage&& other) : count(other.count)
+		{
+			grtw::uninitialized_move(other.data(), other.data() + count, data());
+		}
+
+		static_vector_storage& operator=(const static_vector_storage& other)
+		{
+			if(this != &other)
+			{
+				grtw::destroy(data(), data() + count);
+				count = 0;
+				grtw::uninitialized_copy(other.data(), other.data() + other.count, data());
+				count = other.count;
+			}
+			return *this;
+		}
+
+		static_vector_storage& operator=(static_vector_storage&& other)
+		{
+			if(this != &other)
+			{
+				grtw::destroy(data(), data() + count);
+				count = 0;
+				grtw::uninitialized_move(other.data(), other.data() + other.count, data());
+				count = other.count;
+			}
+			return *this;
+		}
+
+		~static_vector_storage() { grtw::destroy(data(), data() + count); }
+
+		T* data() { return reinterpret_cast<T*>(raw); }
+		const T* data() const { return reinterpret_cast<const T*>(raw); }
+
+		template<class... Args>
+		static void construct(T* p, Args&&... args) { grtw::construct(p, grtw::forward<Args>(args)...); }
+		static void destroy(T* first, T* last) { grtw::destroy(first, last); }
+
+		static T* uninitialized_copy(const T* first, const T* last, T* dest) { return grtw::uninitialized_copy(first, last, dest); }
+		static T* uninitialized_fill_n(T* dest, size_t n, const T& v) { return grtw::uninitialized_fill_n(dest, n, v); }
+	};
+
+	//static_vector: vector interface over a fixed array of N elements inside the object, so it
+	//never allocates; growing past N throws std::bad_alloc
+	template<class T, size_t N>
+	class static_vector
+	{
+		static_assert(N > 0, "static_vector needs a capacity");
+
+	public:
+		using value_type = T;
+		using pointer = T*;
+		using iterator = T*;
+		using const_iterator = const T*;
+		using const_reverse_iterator = Reverse_iterator<const_iterator>;
+		using reverse_iterator = Reverse_iterator<iterator>;
+		using reference = T&;
+		using const_reference = const T&;
+		using size_type = size_t;
+		using difference_type = ptrdiff_t;
+
+	private:
+		using storage = static_vector_storage<T, N>;
+
+		storage impl;
+
+		GRTW_CONSTEXPR14 void check_room(size_type n) const
+		{
+			if(n > N - impl.count)
+				throw std::bad_alloc();
+		}
+
+		//moves [it, end) up by n slots; slots past the old end are raw and get constructed
+		GRTW_CONSTEXPR14 void open_gap(iterator it, size_type n)
+		{
+			if(n == 0)
+				return;
+			iterator old_end = end();
+			iterator src = old_end;
+			iterator dest = old_end + n;
+			while(src != it)
+			{
+				--src;
+				--dest;
+				if(dest >= old_end)
+					storage::construct(dest, grtw::move(*src));
+				else
+					*dest = grtw::move(*src);
+			}
+		}
+
+	public:
+		constexpr static_vector() : impl() {}
+
+		GRTW_CONSTEXPR14 explicit static_vector(size_type n) : impl()
+		{
+			check_room(n);
+			for(; impl.count < n; ++impl.count)
+				storage::construct(impl.data() + impl.count);
+		}
+
+		GRTW_CONSTEXPR14 static_vector(size_type n, const T& v) : impl()
+		{
+			check_room(n);
+			storage::uninitialized_fill_n(impl.data(), n, v);
+			impl.count = n;
+		}
+
+		GRTW_CONSTEXPR14 static_vector(const T* first, const T* last) : impl()
+		{
+			check_room(last - first);
+			storage::uninitialized_copy(first, last, impl.data());
+			impl.count = last - first;
+		}
+
+		GRTW_CONSTEXPR14 iterator begin() { return impl.data(); }
+		GRTW_CONSTEXPR14 iterator end() { return impl.data() + impl.count; }
+		constexpr const_iterator begin() const { return impl.data(); }
+		constexpr const_iterator end() const { return impl.data() + impl.count; }
+		constexpr const_iterator cbegin() const { return impl.data(); }
+		constexpr const_iterator cend() const { return impl.data() + impl.count; }
+		reverse_iterator rbegin() { return reverse_iterator(end()); }
+		reverse_iterator rend() { return reverse_iterator(begin()); }
+		const_reverse_iterator crbegin() const { return const_reverse_iterator(end()); }
+		const_reverse_iterator crend() const { return const_reverse_iterator(begin()); }
+
+		constexpr bool empty() const { return impl.count == 0; }
+		constexpr size_type size() const { return impl.count; }
+		static constexpr size_type capacity() { return N; }
+		static constexpr size_type max_size() { return N; }
+
+		GRTW_CONSTEXPR14 pointer data() { return impl.data(); }
+		constexpr const T* data() const { return impl.data(); }
+		GRTW_CONSTEXPR14 reference operator[](size_type n) { return impl.data()[n]; }
+		constexpr const_reference operator[](size_type n) const { return impl.data()[n]; }
+		GRTW_CONSTEXPR14 reference front() { return impl.data()[0]; }
+		GRTW_CONSTEXPR14 reference back() { return impl.data()[impl.count - 1]; }
+		constexpr const_reference front() const { return impl.data()[0]; }
+		constexpr const_reference back() const { return impl.data()[impl.count - 1]; }
+
+		GRTW_CONSTEXPR14 void push_back(const T& v) { emplace_back(v); }
+		GRTW_CONSTEXPR14 void push_back(T&& v) { emplace_back(grtw::move(v)); }
+
+		template<class... Args>
+		GRTW_CONSTEXPR14 reference emplace_back(Args&&... args)
+		{
+			check_room(1);
+			storage::construct(end(), grtw::forward<Args>(args)...);
+			++impl.count;
+			return back();
+		}
+
+		GRTW_CONSTEXPR14 void pop_back()
+		{
+			--impl.count;
+			storage::destroy(end(), end() + 1);
+		}
+
+		GRTW_CONSTEXPR14 iterator insert(iterator it, const T& v) { return emplace(it, v); }
+		GRTW_CONSTEXPR14 iterator insert(iterator it, T&& v) { return emplace(it, grtw::move(v)); }
+
+		template<class... Args>
+		GRTW_CONSTEXPR14 iterator emplace(iterator it, Args&&... args)
+		{
+			check_room(1);
+			if(it == end())
+				storage::construct(it, grtw::forward<Args>(args)...);
+			else
+			{
+				T tmp(grtw::forward<Args>(args)...);
+				open_gap(it, 1);
+				*it = grtw::move(tmp);
+			}
+			++impl.count;
+			return it;
+		}
+
+		GRTW_CONSTEXPR14 iterator insert(iterator it, size_type n, const T& v)
+		{
+			check_room(n);
+			T tmp(v);
+			iterator old_end = end();
+			open_gap(it, n);
+			for(iterator p = it; p != it + n; ++p)
+			{
+				if(p >= old_end)
+					storage::construct(p, tmp);
+				else
+					*p = tmp;
+			}
+			impl.count += n;
+			return it;
+		}
+
+		GRTW_CONSTEXPR14 iterator insert(iterator it, const_iterator first, const_iterator last)
+		{
+			size_type n = last - first;
+			check_room(n);
+			iterator old_end = end();
+			open_gap(it, n);
+			for(iterator p = it; first != last; ++p, ++first)
+			{
+				if(p >= old_end)
+					storage::construct(p, *first);
+				else
+					*p = *first;
+			}
+			impl.count += n;
+			return it;
+		}
+
+		GRTW_CONSTEXPR14 iterator erase(iterator it) { return erase(it, it + 1); }
+
+		GRTW_CONSTEXPR14 iterator erase(iterator first, iterator last)
+		{
+			if(first == last)
+				return first;
+			iterator dest = first;
+			for(iterator src = last; src != end(); ++src, ++dest)
+				*dest = grtw::move(*src);
+			storage::destroy(dest, end());
+			impl.count = dest - begin();
+			return first;
+		}
+
+		GRTW_CONSTEXPR14 void clear()
+		{
+			storage::destroy(begin(), end());
+			impl.count = 0;
+		}
+
+		GRTW_CONSTEXPR14 void resize(size_type n, const T& v)
+		{
+			if(n < size())
+				erase(begin() + n, end());
+			else
+			{
+				check_room(n - size());
+				storage::uninitialized_fill_n(end(), n - size(), v);
+				impl.count = n;
+			}
+		}
+
+		GRTW_CONSTEXPR14 void resize(size_type n) { resize(n, T()); }
+
+		GRTW_CONSTEXPR14 bool operator==(const static_vector& other) const
+		{
+			if(size() != other.size())
+				return false;
+			for(size_type i = 0; i < size(); ++i)
+				if(!((*this)[i] == other[i]))
+					return false;
+			return true;
+		}
+
+		GRTW_CONSTEXPR14 bool operator!=(const static_vector& other) const { return !(*this == other); }
+	};
+}
+
+#endif
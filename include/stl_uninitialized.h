@@ -12,7 +12,7 @@ namespace grtw
 	template<class InputIterator, class ForwardIterator>
 	inline ForwardIterator __uninitialized_copy(InputIterator first, InputIterator last, ForwardIterator dest, true_type)
 	{
-		return copy(first, last, dest);
+		return grtw::copy(first, last, dest);
 	}
 
 	template<class InputIterator, class ForwardIterator>
@@ -20,7 +20,7 @@ namespace grtw
 	{
 		ForwardIterator cur = dest;
 		for(; first != last; ++first, ++cur)
-			construct(&*cur, *first);
+			grtw::construct(&*cur, *first);
 		return cur;
 	}
 	
@@ -49,11 +49,120 @@ namespace grtw
 		return dest + (last - first);
 	}
 
+	//uninitialized_move: move-constructs into raw storage, POD types take the copy path
+	template<class InputIterator, class ForwardIterator>
+	inline ForwardIterator __uninitialized_move(InputIterator first, InputIterator last, ForwardIterator dest, true_type)
+	{
+		return grtw::copy(first, last, dest);
+	}
+
+	template<class InputIterator, class ForwardIterator>
+	inline ForwardIterator __uninitialized_move(InputIterator first, InputIterator last, ForwardIterator dest, false_type)
+	{
+		ForwardIterator cur = dest;
+		for(; first != last; ++first, ++cur)
+			grtw::construct(&*cur, grtw::move(*first));
+		return cur;
+	}
+
+	template<class InputIterator, class ForwardIterator, class T>
+	inline ForwardIterator _uninitialized_move(InputIterator first, InputIterator last, ForwardIterator dest, T*)
+	{
+		using IS_POD = typename type_traits<T>::is_POD_type;
+		return __uninitialized_move(first, last, dest, IS_POD());
+	}
+
+	template<class InputIterator, class ForwardIterator>
+	inline ForwardIterator uninitialized_move(InputIterator first, InputIterator last, ForwardIterator dest)
+	{
+		return _uninitialized_move(first, last, dest, value_type(dest));
+	}
+
+	//uninitialized_move_if_noexcept: for growing into new storage, moves only when the move
+	//constructor cannot throw so that a failure leaves the old elements intact
+	template<class InputIterator, class ForwardIterator>
+	inline ForwardIterator __uninitialized_move_if_noexcept(InputIterator first, InputIterator last, ForwardIterator dest, true_type)
+	{
+		return grtw::uninitialized_move(first, last, dest);
+	}
+
+	template<class InputIterator, class ForwardIterator>
+	inline ForwardIterator __uninitialized_move_if_noexcept(InputIterator first, InputIterator last, ForwardIterator dest, false_type)
+	{
+		return grtw::uninitialized_copy(first, last, dest);
+	}
+
+	template<class InputIterator, class ForwardIterator, class T>
+	inline ForwardIterator _uninitialized_move_if_noexcept(InputIterator first, InputIterator last, ForwardIterator dest, T*)
+	{
+		using Nothrow = typename Is_nothrow_move_constructible<T>::type;
+		return __uninitialized_move_if_noexcept(first, last, dest, Nothrow());
+	}
+
+	template<class InputIterator, class ForwardIterator>
+	inline ForwardIterator uninitialized_move_if_noexcept(InputIterator first, InputIterator last, ForwardIterator dest)
+	{
+		return _uninitialized_move_if_noexcept(first, last, dest, value_type(dest));
+	}
+
+	//uninitialized_relocate: moves [first, last) to raw storage at dest and ends the lifetime of
+	//the source objects; relocatable types move as bytes, and only then may the ranges overlap
+	template<class T>
+	inline T* __uninitialized_relocate(T* first, T* last, T* dest, true_type)
+	{
+		//memmove must not see the null pointers of an empty vector
+		if(first != last)
+			memmove((void*)dest, (const void*)first, sizeof(T) * (last - first));
+		return dest + (last - first);
+	}
+
+	template<class T>
+	inline T* __uninitialized_relocate(T* first, T* last, T* dest, false_type)
+	{
+		T* res = grtw::uninitialized_move_if_noexcept(first, last, dest);
+		grtw::destroy(first, last);
+		return res;
+	}
+
+	template<class T>
+	inline T* uninitialized_relocate(T* first, T* last, T* dest)
+	{
+		using Relocatable = typename Is_trivially_relocatable<T>::Relocatable;
+		return __uninitialized_relocate(first, last, dest, Relocatable());
+	}
+
+	//uninitialized_default_init: default-initializes, so types with a trivial constructor are
+	//left with indeterminate values and nothing is written
+	template<class ForwardIterator>
+	inline void __uninitialized_default_init(ForwardIterator, ForwardIterator, true_type)
+	{}
+
+	template<class ForwardIterator>
+	void __uninitialized_default_init(ForwardIterator first, ForwardIterator last, false_type)
+	{
+		using T = typename iterator_traits<ForwardIterator>::value_type;
+		for(; first != last; ++first)
+			new ((void*)&*first) T;
+	}
+
+	template<class ForwardIterator, class T>
+	inline void _uninitialized_default_init(ForwardIterator first, ForwardIterator last, T*)
+	{
+		using trivial_constructor = typename type_traits<T>::has_trivial_constructor;
+		__uninitialized_default_init(first, last, trivial_constructor());
+	}
+
+	template<class ForwardIterator>
+	inline void uninitialized_default_init(ForwardIterator first, ForwardIterator last)
+	{
+		_uninitialized_default_init(first, last, value_type(first));
+	}
+
 	//uninitialized_fill
 	template <class ForwardIterator, class T>
 	inline void __uninitialized_fill_aux(ForwardIterator first, ForwardIterator last, const T& x, true_type)
 	{
-		fill(first, last, x);
+		grtw::fill(first, last, x);
 	}
 
 	template <class ForwardIterator, class T>
@@ -61,7 +170,7 @@ namespace grtw
 	{
 		ForwardIterator cur = first;
 	    for(; cur != last; ++cur)
-	    	construct(&*cur, x);
+	    	grtw::construct(&*cur, x);
 	}
 
 	template <class ForwardIterator, class T, class T1>
@@ -81,7 +190,7 @@ namespace grtw
 	template <class ForwardIterator, class _Size, class T>
 	inline ForwardIterator __uninitialized_fill_n_aux(ForwardIterator first, _Size n, const T& x, true_type)
 	{
-		return fill_n(first, n, x);
+		return grtw::fill_n(first, n, x);
 	}
 
 	template <class ForwardIterator, class _Size, class T>
@@ -89,7 +198,7 @@ namespace grtw
 	{
 		ForwardIterator cur = first;
 		for(; n > 0; --n, ++cur)
-			construct(&*cur, x);
+			grtw::construct(&*cur, x);
 	    return cur;
 	}
 
@@ -0,0 +1,57 @@
+#ifndef GRTW_STL_UTILITY_H
+#define GRTW_STL_UTILITY_H
+
+#include"type_traits.h"
+
+namespace grtw
+{
+	template<class T>
+	struct remove_reference
+	{
+		using type = T;
+	};
+
+	template<class T>
+	struct remove_reference<T&>
+	{
+		using type = T;
+	};
+
+	template<class T>
+	struct remove_reference<T&&>
+	{
+		using type = T;
+	};
+
+	//move / forward: call them qualified, an unqualified call can also find std:: ones through ADL
+	template<class T>
+	constexpr typename remove_reference<T>::type&& move(T&& t) noexcept
+	{
+		return static_cast<typename remove_reference<T>::type&&>(t);
+	}
+
+	template<class T>
+	constexpr T&& forward(typename remove_reference<T>::type& t) noexcept
+	{
+		return static_cast<T&&>(t);
+	}
+
+	template<class T>
+	constexpr T&& forward(typename remove_reference<T>::type&& t) noexcept
+	{
+		return static_cast<T&&>(t);
+	}
+
+	template<class T>
+	T&& declval() noexcept;
+
+	//moving elements into new storage is only safe when it cannot throw halfway,
+	//otherwise containers copy and leave the source intact
+	template<class T>
+	struct Is_nothrow_move_constructible
+	{
+		using type = typename Bool_type<noexcept(T(declval<T>()))>::type;
+	};
+}
+
+#endif
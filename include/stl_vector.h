@@ -3,13 +3,35 @@
 
 #include"stl_iterator.h"
 #include"stl_allocator.h"
+#include"stl_allocator_traits.h"
 #include"stl_uninitialized.h"
 #include"stl_algorithms.h"
 #include"type_traits.h"
+#include"stl_utility.h"
 
 namespace grtw
 {
-	template<class T, class Alloc = allocator<T>>
+	//growth policies: given the current capacity and the size that must fit, return the new
+	//capacity. Num/Den = 3/2 wastes less memory and lets the allocator reuse freed blocks,
+	//2/1 reallocates less often; any functor with this call signature can be used
+	template<size_t Num, size_t Den>
+	struct growth_factor
+	{
+		static_assert(Num > Den, "growth factor must be greater than one");
+
+		size_t operator()(size_t capacity, size_t required) const
+		{
+			size_t grown = capacity + capacity * (Num - Den) / Den;
+			if(grown <= capacity)
+				grown = capacity + 1;
+			return grown < required ? required : grown;
+		}
+	};
+
+	using growth_double = growth_factor<2, 1>;
+	using growth_one_and_half = growth_factor<3, 2>;
+
+	template<class T, class Alloc = allocator<T>, class Growth = growth_double>
 	class vector
 	{
 	public:
@@ -23,108 +45,428 @@ namespace grtw
 		using const_reference = const T&;
 		using size_type = size_t;
 		using difference_type = ptrdiff_t;
+		using allocator_type = Alloc;
 
 	private:
-		iterator start;
-		iterator finish;
-		iterator end_of_storage;
+		using alloc_traits = allocator_traits<Alloc>;
+		//relocatable elements are moved with memmove instead of move-construct plus destroy
+		using relocatable = typename Is_trivially_relocatable<T>::Relocatable;
+		//they can also be moved by the allocator's reallocate, which for large blocks is
+		//realloc and may grow the buffer in place instead of copying it
+		using realloc_growth = typename And_type<relocatable, typename alloc_traits::has_reallocate>::type;
+
+		//the allocator is a base of the storage, so a stateless one takes no space
+		struct storage : public Alloc
+		{
+			iterator start;
+			iterator finish;
+			iterator end_of_storage;
+
+			storage(const Alloc& a) : Alloc(a), start(nullptr), finish(nullptr), end_of_storage(nullptr) {}
+		};
+
+		storage impl;
 
 	private:
+		iterator allocate(size_type n)
+		{
+			return alloc_traits::allocate(impl, n);
+		}
+
+		void deallocate(iterator p, size_type n)
+		{
+			if(p != nullptr)
+				alloc_traits::deallocate(impl, p, n);
+		}
+
+		bool reallocate_storage(size_type new_cap, true_type)
+		{
+			if(impl.start == nullptr)
+				return false;
+			size_type old_size = size();
+			impl.start = alloc_traits::reallocate(impl, impl.start, capacity(), new_cap);
+			impl.finish = impl.start + old_size;
+			impl.end_of_storage = impl.start + new_cap;
+			return true;
+		}
+
+		bool reallocate_storage(size_type, false_type) { return false; }
+
+		//grows the buffer in place of the allocate-copy-deallocate path; false if not applicable
+		bool reallocate_storage(size_type new_cap) { return reallocate_storage(new_cap, realloc_growth()); }
+
+		size_type next_capacity(size_type required) const { return Growth()(capacity(), required); }
+
+		//insert at it when the buffer is full: relocatable elements reallocate and retry, others
+		//are constructed in the new buffer first since args may refer to an element of the old one
+		template<class... Args>
+		void grow_emplace(iterator it, true_type, Args&&... args)
+		{
+			size_type n = it - impl.start;
+			T tmp(grtw::forward<Args>(args)...);
+			if(reallocate_storage(next_capacity(size() + 1)))
+				emplace(impl.start + n, grtw::move(tmp));
+			else
+				grow_emplace(it, false_type(), grtw::move(tmp));
+		}
+
+		template<class... Args>
+		void grow_emplace(iterator it, false_type, Args&&... args)
+		{
+			size_type new_size = next_capacity(size() + 1);
+			iterator new_start = allocate(new_size);
+			iterator pos = new_start + (it - impl.start);
+			grtw::construct(pos, grtw::forward<Args>(args)...);
+			grtw::uninitialized_relocate(impl.start, it, new_start);
+			iterator new_finish = grtw::uninitialized_relocate(it, impl.finish, pos + 1);
+			deallocate(impl.start, impl.end_of_storage - impl.start);
+			impl.start = new_start;
+			impl.finish = new_finish;
+			impl.end_of_storage = impl.start + new_size;
+		}
+
+		//shifts [it, finish) up by n slots for an insert, leaving [it, it + n) raw
+		void open_gap(iterator it, size_type n)
+		{
+			grtw::uninitialized_relocate(it, impl.finish, it + n);
+			impl.finish += n;
+		}
+
+		template<class... Args>
+		void emplace_middle(iterator it, true_type, Args&&... args)
+		{
+			T tmp(grtw::forward<Args>(args)...);
+			open_gap(it, 1);
+			grtw::construct(it, grtw::move(tmp));
+		}
+
+		template<class... Args>
+		void emplace_middle(iterator it, false_type, Args&&... args)
+		{
+			T tmp(grtw::forward<Args>(args)...);
+			grtw::construct(impl.finish, grtw::move(*(impl.finish - 1)));
+			++impl.finish;
+			grtw::move_backward(it, impl.finish - 2, impl.finish - 1);
+			*it = grtw::move(tmp);
+		}
+
+		void fill_insert_in_place(iterator it, size_type n, const T& v, true_type)
+		{
+			//v may be an element that the gap moves up
+			const T* src = &v;
+			if(src >= it && src < impl.finish)
+				src += n;
+			open_gap(it, n);
+			grtw::uninitialized_fill_n(it, n, *src);
+		}
+
+		void fill_insert_in_place(iterator it, size_type n, const T& v, false_type)
+		{
+			//v may be an element that the shift moves from
+			T v_copy = v;
+			size_type elems_after = impl.finish - it;
+			iterator old_finish = impl.finish;
+			if(elems_after > n)
+			{
+				grtw::uninitialized_move(impl.finish - n, impl.finish, impl.finish);
+				impl.finish += n;
+				grtw::move_backward(it, old_finish - n, old_finish);
+				grtw::fill(it, it + n, v_copy);
+			}
+			else
+			{
+				grtw::uninitialized_fill_n(impl.finish, n - elems_after, v_copy);
+				impl.finish += n - elems_after;
+				grtw::uninitialized_move(it, old_finish, impl.finish);
+				impl.finish += elems_after;
+				grtw::fill(it, old_finish, v_copy);
+			}
+		}
+
+		template<class ForwardIterator>
+		void range_insert_in_place(iterator it, ForwardIterator first, ForwardIterator last, size_type n, true_type)
+		{
+			open_gap(it, n);
+			grtw::uninitialized_copy(first, last, it);
+		}
+
+		template<class ForwardIterator>
+		void range_insert_in_place(iterator it, ForwardIterator first, ForwardIterator last, size_type n, false_type)
+		{
+			size_type elems_after = impl.finish - it;
+			iterator old_finish = impl.finish;
+			if(elems_after >= n)
+			{
+				grtw::uninitialized_move(old_finish - n, old_finish, old_finish);
+				impl.finish += n;
+				grtw::move_backward(it, old_finish - n, old_finish);
+				grtw::copy(first, last, it);
+			}
+			else
+			{
+				ForwardIterator mid = first;
+				grtw::advance(mid, elems_after);
+				grtw::uninitialized_copy(mid, last, impl.finish);
+				impl.finish = impl.finish + n - elems_after;
+				grtw::uninitialized_move(it, old_finish, impl.finish);
+				impl.finish += elems_after;
+				grtw::copy(first, mid, it);
+			}
+		}
+
+		iterator erase_range(iterator first, iterator last, true_type)
+		{
+			grtw::destroy(first, last);
+			impl.finish = grtw::uninitialized_relocate(last, impl.finish, first);
+			return first;
+		}
+
+		iterator erase_range(iterator first, iterator last, false_type)
+		{
+			//an empty range would move every later element onto itself
+			if(first == last)
+				return first;
+			grtw::move(last, impl.finish, first);
+			iterator new_finish = first + (impl.finish - last);
+			grtw::destroy(new_finish, impl.finish);
+			impl.finish = new_finish;
+			return first;
+		}
+
+		//moves the elements into a buffer of exactly n >= size() slots
+		void reallocate_exact(size_type n)
+		{
+			if(n == 0)
+			{
+				deallocate(impl.start, capacity());
+				impl.start = impl.finish = impl.end_of_storage = nullptr;
+			}
+			else if(!reallocate_storage(n))
+			{
+				size_type old_size = size();
+				iterator tmp = allocate(n);
+				grtw::uninitialized_relocate(impl.start, impl.finish, tmp);
+				deallocate(impl.start, capacity());
+				impl.start = tmp;
+				impl.finish = impl.start + old_size;
+				impl.end_of_storage = impl.start + n;
+			}
+		}
+
+		//makes room for n more elements past finish, growing by the policy
+		void make_room(size_type n)
+		{
+			if(n > size_type(impl.end_of_storage - impl.finish))
+				reallocate_exact(next_capacity(size() + n));
+		}
+
 		void allocate_fill(size_t n, const T& v)
 		{
-			start = Alloc::allocate(n);
-			uninitialized_fill_n(start, n, v);
-			finish = start + n;
-			end_of_storage = finish;
+			impl.start = allocate(n);
+			grtw::uninitialized_fill_n(impl.start, n, v);
+			impl.finish = impl.start + n;
+			impl.end_of_storage = impl.finish;
 		}
 
+		//forward ranges are measured first so the buffer grows once
+		template<class ForwardIterator>
+		void range_insert(iterator it, ForwardIterator first, ForwardIterator last, forward_iterator_tag)
+		{
+			if(first != last)
+			{
+				size_type n = grtw::distance(first, last);
+				size_type remain = impl.end_of_storage - impl.finish;
+				if(remain >= n)
+					range_insert_in_place(it, first, last, n, relocatable());
+				else
+				{
+					size_type old_size = size();
+					size_type new_size = next_capacity(old_size + n);
+					size_type offset = it - impl.start;
+					//a source range inside this vector would not survive the reallocation
+					bool aliased = points_into(first);
+					if(!aliased && reallocate_storage(new_size))
+					{
+						range_insert_in_place(impl.start + offset, first, last, n, relocatable());
+						return;
+					}
+					iterator new_start = allocate(new_size);
+					iterator pos = new_start + offset;
+					grtw::uninitialized_copy(first, last, pos);
+					grtw::uninitialized_relocate(impl.start, it, new_start);
+					iterator new_finish = grtw::uninitialized_relocate(it, impl.finish, pos + n);
+					deallocate(impl.start, impl.end_of_storage - impl.start);
+					impl.start = new_start;
+					impl.finish = new_finish;
+					impl.end_of_storage = impl.start + new_size;
+				}
+			}
+		}
+
+		//the length of an input range is unknown: at the end it is appended with the usual
+		//geometric growth, elsewhere it is gathered first and then inserted in one step
+		template<class InputIterator>
+		void range_insert(iterator it, InputIterator first, InputIterator last, input_iterator_tag)
+		{
+			if(it == impl.finish)
+			{
+				for(; first != last; ++first)
+					emplace_back(*first);
+			}
+			else
+			{
+				vector<T, Alloc, Growth> tmp(first, last, get_allocator());
+				range_insert(it, tmp.begin(), tmp.end(), random_access_iterator_tag());
+			}
+		}
+
+		template<class Integer>
+		void insert_dispatch(iterator it, Integer n, Integer v, true_type) { insert(it, size_type(n), T(v)); }
+
+		template<class InputIterator>
+		void insert_dispatch(iterator it, InputIterator first, InputIterator last, false_type)
+		{
+			range_insert(it, first, last, iterator_category(first));
+		}
+
+		bool points_into(T* p) const { return p >= impl.start && p < impl.end_of_storage; }
+		bool points_into(const T* p) const { return p >= impl.start && p < impl.end_of_storage; }
+		template<class Iterator>
+		bool points_into(const Iterator&) const { return false; }
+
+		template<class Integer>
+		void initialize_dispatch(Integer n, Integer v, true_type) { allocate_fill(n, v); }
+
+		template<class InputIterator>
+		void initialize_dispatch(InputIterator first, InputIterator last, false_type)
+		{
+			range_initialize(first, last, iterator_category(first));
+		}
+
+		template<class InputIterator>
+		void range_initialize(InputIterator first, InputIterator last, input_iterator_tag)
+		{
+			for(; first != last; ++first)
+				emplace_back(*first);
+		}
+
+		template<class ForwardIterator>
+		void range_initialize(ForwardIterator first, ForwardIterator last, forward_iterator_tag)
+		{
+			size_type n = grtw::distance(first, last);
+			impl.start = allocate(n);
+			impl.finish = grtw::uninitialized_copy(first, last, impl.start);
+			impl.end_of_storage = impl.start + n;
+		}
+
+	protected:
+		//the allocator instance itself, for containers built on vector that keep state in it
+		Alloc& allocator_instance() { return impl; }
+		const Alloc& allocator_instance() const { return impl; }
+
 	//construct and destruct	
 	public:
-		vector() : start(nullptr), finish(nullptr), end_of_storage(nullptr) {}
+		vector() : impl(Alloc()) {}
+
+		explicit vector(const Alloc& a) : impl(a) {}
 
-		explicit vector(size_type n)
+		explicit vector(size_type n, const Alloc& a = Alloc()) : impl(a)
 		{
 			allocate_fill(n, T());
 		}
 
-		vector(size_type n, const T& v)
+		vector(size_type n, const T& v, const Alloc& a = Alloc()) : impl(a)
 		{
 			allocate_fill(n, v);
 		}
 
-		vector(int n, const T& v)
+		vector(int n, const T& v, const Alloc& a = Alloc()) : impl(a)
 		{
 			allocate_fill(n, v);
 		}
 
-		vector(long n, const T& v)
+		vector(long n, const T& v, const Alloc& a = Alloc()) : impl(a)
 		{
 			allocate_fill(n, v);
 		}
 
-		vector(const vector<T, Alloc>& v)
+		vector(const vector<T, Alloc, Growth>& v) : impl(alloc_traits::select_on_container_copy_construction(v.impl))
 		{
 			size_t n = v.size();
-			start = Alloc::allocate(n);
-			uninitialized_copy(v.begin(), v.end(), start);
-			finish = start + n;
-			end_of_storage = finish;
+			impl.start = allocate(n);
+			grtw::uninitialized_copy(v.begin(), v.end(), impl.start);
+			impl.finish = impl.start + n;
+			impl.end_of_storage = impl.finish;
+		}
+
+		vector(vector<T, Alloc, Growth>&& v) noexcept : impl(v.impl)
+		{
+			v.impl.start = v.impl.finish = v.impl.end_of_storage = nullptr;
 		}
 
-		vector(const T* first, const T* last)
+		template<class InputIterator>
+		vector(InputIterator first, InputIterator last, const Alloc& a = Alloc()) : impl(a)
 		{
-			size_t n = last - first;
-			start = Alloc::allocate(n);
-			uninitialized_copy(first, last, start);
-			finish = start + n;
-			end_of_storage = finish;
+			initialize_dispatch(first, last, typename Is_integer<InputIterator>::Integral());
 		}
 
-		vector& operator=(const vector<T, Alloc>& v)
+		vector& operator=(const vector<T, Alloc, Growth>& v)
 		{
-			if(this != v.begin())
+			if(this != &v)
 			{
-				Alloc::destroy(start, finish);
+				grtw::destroy(impl.start, impl.finish);
 				size_t n = v.size();
 				if(capacity() >= n)
-					finish = uninitialized_copy(v.begin(), v.end(), start);
+					impl.finish = grtw::uninitialized_copy(v.begin(), v.end(), impl.start);
 				else
 				{
-					Alloc::deallocate(start, end_of_storage - start);
-					start = Alloc::allocate(n);
-					uninitialized_copy(v.begin(), v.end(), start);
-					finish = start + n;
-					end_of_storage = finish;
+					deallocate(impl.start, impl.end_of_storage - impl.start);
+					impl.start = allocate(n);
+					grtw::uninitialized_copy(v.begin(), v.end(), impl.start);
+					impl.finish = impl.start + n;
+					impl.end_of_storage = impl.finish;
 				}
 			}
 			return *this;
 		}
 
+		vector& operator=(vector<T, Alloc, Growth>&& v) noexcept
+		{
+			vector<T, Alloc, Growth> tmp(grtw::move(v));
+			swap(tmp);
+			return *this;
+		}
+
 		~vector()
 		{
-			Alloc::destroy(start, finish);
-			Alloc::deallocate(start, end_of_storage - start);
+			grtw::destroy(impl.start, impl.finish);
+			deallocate(impl.start, impl.end_of_storage - impl.start);
 		}
 
 	//interface
 	public:
-		bool empty() const { return start == finish; }
-
-		iterator begin() { return start; }
-		iterator end() { return finish; }
-		const_iterator begin() const { return start; }
-		const_iterator end() const { return finish; }
-		const_iterator cbegin() const {return start; }
-		const_iterator cend() const { return finish; }
-		reverse_iterator rbegin() { return reverse_iterator(finish); }
-		reverse_iterator rend() { return reverse_iterator(start); }
-		const_reverse_iterator crbegin() const { return reverse_iterator(finish); }
-		const_reverse_iterator crend() const { return reverse_iterator(start); }
-
-		size_type size() { return finish - start; }
-		size_type capacity() { return end_of_storage - start; }
+		allocator_type get_allocator() const { return impl; }
+
+		void swap(vector<T, Alloc, Growth>& v) noexcept { grtw::swap(impl, v.impl); }
+
+		bool empty() const { return impl.start == impl.finish; }
+
+		iterator begin() { return impl.start; }
+		iterator end() { return impl.finish; }
+		const_iterator begin() const { return impl.start; }
+		const_iterator end() const { return impl.finish; }
+		const_iterator cbegin() const {return impl.start; }
+		const_iterator cend() const { return impl.finish; }
+		reverse_iterator rbegin() { return reverse_iterator(impl.finish); }
+		reverse_iterator rend() { return reverse_iterator(impl.start); }
+		const_reverse_iterator crbegin() const { return reverse_iterator(impl.finish); }
+		const_reverse_iterator crend() const { return reverse_iterator(impl.start); }
+
+		size_type size() const { return impl.finish - impl.start; }
+		size_type capacity() const { return impl.end_of_storage - impl.start; }
 		
 		reference operator[](size_type n) { return *(begin() + n); }
+		const_reference operator[](size_type n) const { return *(begin() + n); }
 		reference front() { return *begin(); }
 		reference back() { return *(end() - 1); }
 		const_reference front() const { return *cbegin(); }
@@ -133,192 +475,148 @@ namespace grtw
 		void resize(size_type n, const T& v = T())
 		{
 			if(n < size())
-				erase(start + n, finish);
+				erase(impl.start + n, impl.finish);
 			else
-				insert(finish, n - size(), v);
+				insert(impl.finish, n - size(), v);
 		}
 
-		void reserve(size_type n)
+		//new elements are default-initialized: trivial types are left as the memory was, which
+		//spares the zero fill of a buffer that is about to be overwritten anyway
+		void resize_default_init(size_type n)
 		{
-			if(n > capacity())
+			if(n < size())
+				erase(impl.start + n, impl.finish);
+			else
 			{
-				size_type old_size = size();
-				iterator tmp = Alloc::allocate(n);
-				uninitialized_copy(start, finish, tmp);
-				Alloc::destroy(start, finish);
-				Alloc::deallocate(start, end_of_storage - start);
-				start = tmp;
-				finish = start + old_size;
-				end_of_storage = start + n;
+				make_room(n - size());
+				grtw::uninitialized_default_init(impl.finish, impl.start + n);
+				impl.finish = impl.start + n;
 			}
 		}
 
-		void push_back(const T& v)
+		//returns raw storage for n elements past end() without changing size(); the caller
+		//constructs the first k of them (plain writes for trivial types) and calls commit_append(k)
+		pointer append_uninitialized(size_type n)
 		{
-			insert(end(), v);
+			make_room(n);
+			return impl.finish;
 		}
 
-		iterator insert(iterator it, const T& v)
+		void commit_append(size_type n) { impl.finish += n; }
+
+		//reserve and shrink_to_fit allocate exactly what is asked, the growth policy is not applied
+		void reserve(size_type n)
 		{
-			size_type n = it - start;
-			if(finish != end_of_storage)
+			if(n > capacity())
+				reallocate_exact(n);
+		}
+
+		void shrink_to_fit()
+		{
+			if(capacity() > size())
+				reallocate_exact(size());
+		}
+
+		void push_back(const T& v) { emplace_back(v); }
+		void push_back(T&& v) { emplace_back(grtw::move(v)); }
+
+		template<class... Args>
+		void emplace_back(Args&&... args)
+		{
+			if(impl.finish != impl.end_of_storage)
 			{
-				if(it == finish)
-				{
-					construct(finish, v);
-					++finish;
-				}
-				else
-				{
-					construct(finish, *(finish - 1));
-					++finish;
-					copy_backward(it, finish - 2, finish - 1);
-					*it = v;
-				}
+				grtw::construct(impl.finish, grtw::forward<Args>(args)...);
+				++impl.finish;
 			}
 			else
-			{
-				size_type old_size = size();
-				size_type new_size = old_size == 0 ? 1 : old_size * 2;
-				iterator new_start = Alloc::allocate(new_size);
-				iterator new_finish = new_start;
-				new_finish = uninitialized_copy(start, it, new_start);
-				construct(new_finish, v);
-				++new_finish;
-				new_finish = uninitialized_copy(it, finish, new_finish);
-				destroy(start, finish);
-				Alloc::deallocate(start, end_of_storage - start);
-				start = new_start;
-				finish = new_finish;
-				end_of_storage = start + new_size;
-			}
-			return start + n;
+				grow_emplace(impl.finish, realloc_growth(), grtw::forward<Args>(args)...);
 		}
 
-		void insert(iterator it, size_type n, const T& v)
+		iterator insert(iterator it, const T& v) { return emplace(it, v); }
+		iterator insert(iterator it, T&& v) { return emplace(it, grtw::move(v)); }
+
+		template<class... Args>
+		iterator emplace(iterator it, Args&&... args)
 		{
-			if(n != 0)
+			size_type n = it - impl.start;
+			if(impl.finish != impl.end_of_storage)
 			{
-				size_type remain = end_of_storage - finish;
-				if(n <= remain)
+				if(it == impl.finish)
 				{
-					size_type elems_after = finish - it;
-					iterator old_finish = finish;
-					if(elems_after > n)
-					{
-						uninitialized_copy(finish - n, finish, finish);
-						finish += n;
-						copy_backward(it, old_finish - n, finish);
-						fill(it, it + n, v);
-					}
-					else
-					{
-						uninitialized_fill_n(it, n - elems_after, v);
-						finish += n - elems_after;
-						uninitialized_copy(it, old_finish, finish);
-						finish += elems_after;
-						fill(it, old_finish, v);
-					}
+					grtw::construct(impl.finish, grtw::forward<Args>(args)...);
+					++impl.finish;
 				}
 				else
-				{
-					size_type old_size = size();
-					size_type new_size = old_size + max(old_size, n);
-					iterator new_start = Alloc::allocate(new_size);
-					iterator new_finish = new_start;
-					new_finish = uninitialized_copy(start, it, new_start);
-					new_finish = uninitialized_fill_n(new_finish, n, v);
-					new_finish = uninitialized_copy(it, finish, new_finish);
-					destroy(start, finish);
-					Alloc::deallocate(start, end_of_storage - start);
-					start = new_start;
-					finish = new_finish;
-					end_of_storage = start + new_size;
-				}
+					emplace_middle(it, relocatable(), grtw::forward<Args>(args)...);
 			}
+			else
+				grow_emplace(it, realloc_growth(), grtw::forward<Args>(args)...);
+			return impl.start + n;
 		}
 
-		void insert(iterator it, const_iterator first, const_iterator last)
+		void insert(iterator it, size_type n, const T& v)
 		{
-			if(first != last)
+			if(n != 0)
 			{
-				size_type n = distance(first, last);
-				size_type remain = end_of_storage - finish;
-				if(remain >= n)
-				{
-					size_type elems_after = finish - it;
-					iterator old_finish = finish;
-					if(elems_after >= n)
-					{
-						uninitialized_copy(old_finish - n, old_finish, old_finish);
-						finish += n;
-						copy_backward(it, old_finish - n, old_finish);
-						copy(first, last, it);
-					}
-					else
-					{
-						uninitialized_copy(first + elems_after, last, finish);
-						finish = finish + n - elems_after;
-						uninitialized_copy(it, old_finish, finish);
-						finish += elems_after;
-						copy(first, first + elems_after, it);
-					}
-				}
+				size_type remain = impl.end_of_storage - impl.finish;
+				if(n <= remain)
+					fill_insert_in_place(it, n, v, relocatable());
 				else
 				{
 					size_type old_size = size();
-					size_type new_size = old_size + max(old_size, n);
-					iterator new_start = Alloc::allocate(new_size);
-					iterator new_finish = new_start;
-					new_finish = uninitialized_copy(start, it, new_start);
-					new_finish = uninitialized_copy(first, last, new_finish);
-					new_finish = uninitialized_copy(it, finish, new_finish);
-					destroy(start, finish);
-					Alloc::deallocate(start);
-					start = new_start;
-					finish = new_finish;
-					end_of_storage = start + new_size;
+					size_type new_size = next_capacity(old_size + n);
+					size_type offset = it - impl.start;
+					T v_copy = v;
+					if(reallocate_storage(new_size))
+					{
+						insert(impl.start + offset, n, v_copy);
+						return;
+					}
+					//the new elements go in first, the source may be an element of the old buffer
+					iterator new_start = allocate(new_size);
+					iterator pos = new_start + offset;
+					grtw::uninitialized_fill_n(pos, n, v);
+					grtw::uninitialized_relocate(impl.start, it, new_start);
+					iterator new_finish = grtw::uninitialized_relocate(it, impl.finish, pos + n);
+					deallocate(impl.start, impl.end_of_storage - impl.start);
+					impl.start = new_start;
+					impl.finish = new_finish;
+					impl.end_of_storage = impl.start + new_size;
 				}
 			}
 		}
 
-		void pop_back()
+		template<class InputIterator>
+		void insert(iterator it, InputIterator first, InputIterator last)
 		{
-			--finish;
-			destroy(finish);
+			insert_dispatch(it, first, last, typename Is_integer<InputIterator>::Integral());
 		}
 
-		iterator erase(iterator it)
-		{
-			if(it + 1 != finish)
-				copy(it + 1, finish, it);
-			--finish;
-			destroy(finish);
-			return it;
-		}
+		template<class InputIterator>
+		void append_range(InputIterator first, InputIterator last) { insert(impl.finish, first, last); }
 
-		iterator erase(iterator first, iterator last)
+		void pop_back()
 		{
-			copy(last, finish, first);
-			iterator new_finish = first + (finish - last);
-			destroy(new_finish, finish);
-			finish = new_finish;
-			return first;
+			--impl.finish;
+			grtw::destroy(impl.finish);
 		}
 
+		iterator erase(iterator it) { return erase_range(it, it + 1, relocatable()); }
+		iterator erase(iterator first, iterator last) { return erase_range(first, last, relocatable()); }
+
 		void clear()
 		{
-			erase(start, finish);
+			erase(impl.start, impl.finish);
 		}
 
-		template<class T1, class Alloc1>
-		bool operator==(const vector<T1, Alloc1>& other)
+		template<class T1, class Alloc1, class Growth1>
+		bool operator==(const vector<T1, Alloc1, Growth1>& other)
 		{
-			return size() == other.size() && equal(start, finish, other.begin());
+			return size() == other.size() && grtw::equal(impl.start, impl.finish, other.begin());
 		}
 
-		template<class T1, class Alloc1>
-		bool operator!=(const vector<T1, Alloc1>& other)
+		template<class T1, class Alloc1, class Growth1>
+		bool operator!=(const vector<T1, Alloc1, Growth1>& other)
 		{
 			return !(this->operator==(other));
 		}
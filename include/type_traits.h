@@ -6,14 +6,42 @@ namespace grtw
 	struct true_type {};
 	struct false_type {};
 	
+	template<bool B>
+	struct Bool_type
+	{
+		using type = false_type;
+	};
+
+	template<>
+	struct Bool_type<true>
+	{
+		using type = true_type;
+	};
+
+	template<class T1, class T2>
+	struct And_type
+	{
+		using type = false_type;
+	};
+
+	template<>
+	struct And_type<true_type, true_type>
+	{
+		using type = true_type;
+	};
+
+	//the primary template asks the compiler, so user types with trivial members take the
+	//memmove / memset paths without a specialization; is_POD_type means the type can be
+	//copied into raw storage by assignment, which the uninitialized_* fast paths rely on
 	template<class T>
 	struct type_traits
 	{
-		using has_trivial_constructor = false_type;
-		using has_trivial_copy_constructor = false_type;
-		using has_assignment_operator = false_type;
-		using has_trivial_destructor = false_type;
-		using is_POD_type = false_type;
+		using has_trivial_constructor = typename Bool_type<__is_trivially_constructible(T)>::type;
+		using has_trivial_copy_constructor = typename Bool_type<__is_trivially_constructible(T, const T&)>::type;
+		using has_assignment_operator = typename Bool_type<__is_trivially_assignable(T&, const T&)>::type;
+		using has_trivial_destructor = typename Bool_type<__has_trivial_destructor(T)>::type;
+		using is_POD_type = typename Bool_type<__is_trivially_copyable(T) && __is_trivially_constructible(T, const T&)
+			&& __is_trivially_assignable(T&, const T&)>::type;
 	};
 
 	template<>
@@ -186,7 +214,6 @@ namespace grtw
 		using is_POD_type = true_type;
 	};
 
-
 	//Is_integer
 	template <class T>
 	struct Is_integer
@@ -271,6 +298,15 @@ namespace grtw
 	{
 		using Integral = true_type;
 	};
+
+	//Is_trivially_relocatable: an object can be moved to new storage by copying its bytes and
+	//forgetting the old copy. Deduced for trivially copyable types; specialize it for others
+	//that are safe to move this way, e.g. a type owning a unique pointer
+	template<class T>
+	struct Is_trivially_relocatable
+	{
+		using Relocatable = typename Bool_type<__is_trivially_copyable(T)>::type;
+	};
 }
 
 #endif
\ No newline at end of file